@@ -0,0 +1,163 @@
+#include "fake_driver.h"
+#include "driver/i2c.h"
+#include <string.h>
+
+fake_spi_t fake_spi;
+uint8_t fake_gpio_level[64];
+
+static struct fake_spi_device {
+  int unused;
+} s_device;
+
+void fake_driver_reset(gpio_num_t dc_pin, test_panel_t *panel) {
+  memset(&fake_spi, 0, sizeof(fake_spi));
+  memset(fake_gpio_level, 0, sizeof(fake_gpio_level));
+  fake_spi.dc_pin = dc_pin;
+  fake_spi.panel = panel;
+}
+
+// ============================================================================
+// GPIO
+// ============================================================================
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+  if (gpio_num < 0 || gpio_num >= (int)sizeof(fake_gpio_level)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  fake_gpio_level[gpio_num] = level != 0;
+  return ESP_OK;
+}
+
+// ============================================================================
+// I2C: every transfer is acknowledged
+// ============================================================================
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config) {
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode,
+                             size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags) {
+  return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t *buffer, uint32_t size) {
+  return buffer;
+}
+
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd) {}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                bool ack_en) {
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data,
+                           size_t len, bool ack_en) {
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t len,
+                          i2c_ack_type_t ack) {
+  memset(data, 0, len);
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd,
+                               TickType_t ticks_to_wait) {
+  return ESP_OK;
+}
+
+// ============================================================================
+// SPI
+// ============================================================================
+
+esp_err_t spi_bus_initialize(spi_host_device_t host,
+                             const spi_bus_config_t *config, int dma_chan) {
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host,
+                             const spi_device_interface_config_t *config,
+                             spi_device_handle_t *handle) {
+  if (config->queue_size <= 0 || config->queue_size > FAKE_SPI_QUEUE_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  fake_spi.config = *config;
+  *handle = &s_device;
+  return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle,
+                                 spi_transaction_t *trans,
+                                 TickType_t ticks_to_wait) {
+  fake_spi.queue_calls++;
+  if (fake_spi.queue_calls == fake_spi.fail_call) {
+    return ESP_ERR_NO_MEM;
+  }
+  // The real driver would block here forever
+  if (fake_spi.inflight == (size_t)fake_spi.config.queue_size) {
+    fake_spi.overflows++;
+    return ESP_ERR_TIMEOUT;
+  }
+
+  for (size_t i = 0; i < fake_spi.inflight; i++) {
+    if (fake_spi.queue[i] == trans) {
+      fake_spi.clobbered++;
+    }
+  }
+  fake_spi.queue[fake_spi.inflight] = trans;
+  fake_spi.queued[fake_spi.inflight] = *trans;
+  fake_spi.inflight++;
+  return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle,
+                                      spi_transaction_t **trans,
+                                      TickType_t ticks_to_wait) {
+  // The real driver would block here forever
+  if (fake_spi.inflight == 0) {
+    return ESP_ERR_TIMEOUT;
+  }
+
+  spi_transaction_t *t = fake_spi.queue[0];
+  if (memcmp(t, &fake_spi.queued[0], sizeof(*t)) != 0) {
+    fake_spi.clobbered++;
+  }
+  fake_spi.inflight--;
+  memmove(&fake_spi.queue[0], &fake_spi.queue[1],
+          fake_spi.inflight * sizeof(fake_spi.queue[0]));
+  memmove(&fake_spi.queued[0], &fake_spi.queued[1],
+          fake_spi.inflight * sizeof(fake_spi.queued[0]));
+
+  // Run the transfer
+  if (fake_spi.config.pre_cb != NULL) {
+    fake_spi.config.pre_cb(t);
+  }
+  if (fake_spi.panel != NULL) {
+    const uint8_t *bytes = (t->flags & SPI_TRANS_USE_TXDATA)
+                               ? t->tx_data
+                               : (const uint8_t *)t->tx_buffer;
+    test_panel_feed(fake_spi.panel, bytes, t->length / 8,
+                    fake_gpio_level[fake_spi.dc_pin]);
+  }
+  if (fake_spi.config.post_cb != NULL) {
+    fake_spi.config.post_cb(t);
+  }
+
+  *trans = t;
+  return ESP_OK;
+}
@@ -0,0 +1,46 @@
+#ifndef FAKE_DRIVER_H
+#define FAKE_DRIVER_H
+
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "test_panel.h"
+#include <stddef.h>
+
+// Host builds compile the I2C and SPI transports against the headers in
+// fake_include/ (SH1106_BUS_DRIVERS=1). I2C transfers always succeed; the
+// SPI device is a transaction queue the tests can inspect and break.
+
+#define FAKE_SPI_QUEUE_MAX 16
+
+// Fake SPI device. Queued transactions run, oldest first, when the driver
+// collects them with spi_device_get_trans_result(): the pre/post callbacks
+// are called and the bytes go to @c panel with the D/C level they set.
+typedef struct {
+  spi_device_interface_config_t config;
+  gpio_num_t dc_pin;   // Pin whose level is the D/C line
+  test_panel_t *panel; // Receives the bytes (may be NULL)
+
+  spi_transaction_t *queue[FAKE_SPI_QUEUE_MAX]; // In flight, oldest first
+  spi_transaction_t queued[FAKE_SPI_QUEUE_MAX]; // ... as they were queued
+  size_t inflight;
+
+  unsigned queue_calls; // spi_device_queue_trans() calls
+  unsigned fail_call;   // Fail this queue call (1-based); 0 = none
+  unsigned overflows;   // Queue calls with queue_size already in flight
+  unsigned clobbered;   // Descriptors reused or changed while in flight
+} fake_spi_t;
+
+extern fake_spi_t fake_spi;
+
+// Output levels set with gpio_set_level()
+extern uint8_t fake_gpio_level[64];
+
+/**
+ * @brief Reset the fake SPI device and the GPIO levels
+ *
+ * @param dc_pin D/C pin the tests configure
+ * @param panel Panel model to deliver transfers to (may be NULL)
+ */
+void fake_driver_reset(gpio_num_t dc_pin, test_panel_t *panel);
+
+#endif // FAKE_DRIVER_H
@@ -0,0 +1,63 @@
+// Fake of the ESP-IDF legacy I2C driver for host builds (see fake_driver.h)
+#ifndef FAKE_DRIVER_I2C_H
+#define FAKE_DRIVER_I2C_H
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int i2c_port_t;
+
+typedef enum {
+  I2C_MODE_SLAVE = 0,
+  I2C_MODE_MASTER,
+} i2c_mode_t;
+
+typedef enum {
+  I2C_MASTER_WRITE = 0,
+  I2C_MASTER_READ,
+} i2c_rw_t;
+
+typedef enum {
+  I2C_MASTER_ACK = 0,
+  I2C_MASTER_NACK,
+  I2C_MASTER_LAST_NACK,
+} i2c_ack_type_t;
+
+typedef struct {
+  i2c_mode_t mode;
+  int sda_io_num;
+  int scl_io_num;
+  gpio_pullup_t sda_pullup_en;
+  gpio_pullup_t scl_pullup_en;
+  struct {
+    uint32_t clk_speed;
+  } master;
+  uint32_t clk_flags;
+} i2c_config_t;
+
+typedef void *i2c_cmd_handle_t;
+
+#define I2C_LINK_RECOMMENDED_SIZE(n) (64 * (n))
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config);
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode,
+                             size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags);
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t *buffer, uint32_t size);
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data,
+                           size_t len, bool ack_en);
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t len,
+                          i2c_ack_type_t ack);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd,
+                               TickType_t ticks_to_wait);
+
+#endif // FAKE_DRIVER_I2C_H
@@ -0,0 +1,206 @@
+#include "sh1106.h"
+#include "sh1106_anim.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CLIP_FPS 50
+#define CLIP_FRAMES 6
+#define CLIP_KEY_SIZE (SH1106_WIDTH * SH1106_PAGES)
+
+// Delta spans, by frame; frame 0 is an all-clear keyframe
+typedef struct {
+  uint8_t frame;
+  uint8_t page;
+  uint8_t x;
+  uint8_t len;
+} clip_span_t;
+
+static const clip_span_t s_spans[] = {
+    {1, 1, 10, 4}, {1, 3, 100, 2}, {2, 0, 0, 8},
+    {3, 2, 60, 3}, {4, 1, 40, 3},  {5, 3, 0, 8},
+};
+#define CLIP_SPANS (sizeof(s_spans) / sizeof(s_spans[0]))
+
+static uint8_t s_clip[SH1106_ANIM_HEADER_SIZE + CLIP_FRAMES * 4 + 1 +
+                      CLIP_KEY_SIZE + CLIP_FRAMES * 3 + CLIP_SPANS * 11];
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_anim_t s_anim;
+
+static uint8_t span_byte(const clip_span_t *span, uint8_t i) {
+  return (uint8_t)(0x11 * span->frame + i + 1);
+}
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    p[i] = (v >> (8 * i)) & 0xFF;
+  }
+  return p + 4;
+}
+
+// Encode the clip the way tools/sh1106_anim_encode.py lays it out
+static size_t build_clip(void) {
+  uint8_t *p = s_clip;
+  memcpy(p, SH1106_ANIM_MAGIC, 4);
+  p[4] = SH1106_ANIM_VERSION;
+  p[5] = SH1106_WIDTH;
+  p[6] = SH1106_PAGES;
+  p[7] = 0;
+  put_u16(p + 8, CLIP_FRAMES);
+  put_u16(p + 10, CLIP_FPS);
+  put_u32(p + 12, 0);
+
+  uint8_t *table = p + SH1106_ANIM_HEADER_SIZE;
+  p = table + CLIP_FRAMES * 4;
+
+  put_u32(table, p - s_clip);
+  *p++ = SH1106_ANIM_FRAME_KEY;
+  memset(p, 0, CLIP_KEY_SIZE);
+  p += CLIP_KEY_SIZE;
+
+  for (uint8_t frame = 1; frame < CLIP_FRAMES; frame++) {
+    put_u32(table + frame * 4, p - s_clip);
+    *p++ = SH1106_ANIM_FRAME_DELTA;
+    uint8_t *count = p;
+    p += 2;
+    uint16_t spans = 0;
+    for (size_t i = 0; i < CLIP_SPANS; i++) {
+      const clip_span_t *span = &s_spans[i];
+      if (span->frame != frame) {
+        continue;
+      }
+      *p++ = span->page;
+      *p++ = span->x;
+      *p++ = span->len;
+      for (uint8_t j = 0; j < span->len; j++) {
+        *p++ = span_byte(span, j);
+      }
+      spans++;
+    }
+    put_u16(count, spans);
+  }
+
+  TEST_ASSERT_LESS_OR_EQUAL(sizeof(s_clip), p - s_clip);
+  return p - s_clip;
+}
+
+static void expect_clean(void) {
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    TEST_ASSERT_GREATER_OR_EQUAL(s_handle.dirty_end[page],
+                                 s_handle.dirty_start[page]);
+  }
+}
+
+TEST_CASE("anim delta frames dirty only their spans", "[sh1106][anim]") {
+  size_t size = build_clip();
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_anim_open_memory(&s_anim, s_clip, size));
+  TEST_ASSERT_EQUAL(CLIP_FRAMES, s_anim.frame_count);
+
+  // The keyframe replaces the whole buffer
+  memset(s_handle.buffer, 0xFF, sizeof(s_handle.buffer));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_anim_decode_next(&s_anim, &s_handle));
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    TEST_ASSERT_EQUAL(0, s_handle.dirty_start[page]);
+    TEST_ASSERT_EQUAL(SH1106_WIDTH, s_handle.dirty_end[page]);
+  }
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  expect_clean();
+
+  // Frame 1 touches page 1 columns 10-13 and page 3 columns 100-101
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_anim_decode_next(&s_anim, &s_handle));
+  TEST_ASSERT_EQUAL(10, s_handle.dirty_start[1]);
+  TEST_ASSERT_EQUAL(14, s_handle.dirty_end[1]);
+  TEST_ASSERT_EQUAL(100, s_handle.dirty_start[3]);
+  TEST_ASSERT_EQUAL(102, s_handle.dirty_end[3]);
+  TEST_ASSERT_GREATER_OR_EQUAL(s_handle.dirty_end[0], s_handle.dirty_start[0]);
+  TEST_ASSERT_GREATER_OR_EQUAL(s_handle.dirty_end[2], s_handle.dirty_start[2]);
+  for (uint8_t j = 0; j < 4; j++) {
+    TEST_ASSERT_EQUAL_HEX8(span_byte(&s_spans[0], j),
+                           s_handle.buffer[1][10 + j]);
+  }
+  TEST_ASSERT_EQUAL_HEX8(0x00, s_handle.buffer[1][9]);
+  TEST_ASSERT_EQUAL_HEX8(0x00, s_handle.buffer[1][14]);
+
+  // Spans of undisplayed frames accumulate
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_anim_decode_next(&s_anim, &s_handle));
+  TEST_ASSERT_EQUAL(0, s_handle.dirty_start[0]);
+  TEST_ASSERT_EQUAL(8, s_handle.dirty_end[0]);
+  TEST_ASSERT_EQUAL(10, s_handle.dirty_start[1]);
+  TEST_ASSERT_EQUAL(14, s_handle.dirty_end[1]);
+
+  for (uint8_t frame = 3; frame < CLIP_FRAMES; frame++) {
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_anim_decode_next(&s_anim, &s_handle));
+  }
+  TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND,
+                    sh1106_anim_decode_next(&s_anim, &s_handle));
+  TEST_ASSERT_EQUAL(CLIP_FRAMES, s_anim.stats.frames_decoded);
+  sh1106_anim_close(&s_anim);
+}
+
+TEST_CASE("anim play from a file drops frames while the bus is behind",
+          "[sh1106][anim]") {
+  size_t size = build_clip();
+  char path[] = "/tmp/sh1106_anim_XXXXXX";
+  int fd = mkstemp(path);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+  TEST_ASSERT_EQUAL(size, write(fd, s_clip, size));
+  close(fd);
+
+  TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND,
+                    sh1106_anim_open_file(&s_anim, "/nonexistent/clip.bin"));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_anim_open_file(&s_anim, path));
+  unlink(path);
+  TEST_ASSERT_TRUE(s_anim.file_mapped);
+
+  // The keyframe's flush stalls for ten frame periods: frames 1-4 are
+  // decoded but not sent, and the last frame sends their spans together
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  s_panel.stall_us = 10 * 1000000 / CLIP_FPS;
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_anim_play(&s_anim, &s_handle, 1));
+
+  sh1106_anim_stats_t stats;
+  sh1106_anim_get_stats(&s_anim, &stats);
+  TEST_ASSERT_EQUAL(CLIP_FRAMES, stats.frames_decoded);
+  TEST_ASSERT_EQUAL(2, stats.frames_shown);
+  TEST_ASSERT_EQUAL(CLIP_FRAMES - 2, stats.frames_dropped);
+  TEST_ASSERT_GREATER_OR_EQUAL(8 * 1000000 / CLIP_FPS, stats.max_late_us);
+
+  // Bytes sent are the keyframe plus, per page, the union of the spans
+  uint32_t expected = CLIP_KEY_SIZE;
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    uint8_t lo = SH1106_WIDTH, hi = 0;
+    for (size_t i = 0; i < CLIP_SPANS; i++) {
+      if (s_spans[i].page == page) {
+        lo = s_spans[i].x < lo ? s_spans[i].x : lo;
+        hi = s_spans[i].x + s_spans[i].len > hi ? s_spans[i].x + s_spans[i].len
+                                                : hi;
+      }
+    }
+    expected += hi > lo ? hi - lo : 0;
+  }
+  TEST_ASSERT_EQUAL(expected, stats.bytes_sent);
+
+  // Nothing was lost with the dropped flushes
+  expect_clean();
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(s_handle.buffer[page],
+                                 &s_panel.ram[page][SH1106_COLUMN_OFFSET],
+                                 SH1106_WIDTH);
+  }
+
+  sh1106_anim_close(&s_anim);
+  TEST_ASSERT_NULL(s_anim.data);
+  TEST_ASSERT_FALSE(s_anim.file_mapped);
+}
@@ -0,0 +1,138 @@
+#include "sh1106.h"
+#include "sh1106_chart.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <string.h>
+
+#define CHART_PAGE 1
+#define CHART_PAGES 2
+#define CHART_ROWS (CHART_PAGES * 8)
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_chart_t s_chart;
+
+// Rows set in one chart column
+static uint8_t column_height(uint8_t col) {
+  uint8_t rows = 0;
+  for (uint8_t p = 0; p < CHART_PAGES; p++) {
+    uint8_t bits = s_handle.buffer[CHART_PAGE + p][s_chart.x + col];
+    for (; bits != 0; bits &= bits - 1) {
+      rows++;
+    }
+  }
+  return rows;
+}
+
+// The shifted framebuffer must match a full redraw from the ring
+static void expect_same_as_redraw(void) {
+  static uint8_t shifted[SH1106_PAGES][SH1106_WIDTH];
+  memcpy(shifted, s_handle.buffer, sizeof(shifted));
+  sh1106_chart_redraw(&s_chart);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(&shifted[0][0], &s_handle.buffer[0][0],
+                               sizeof(shifted));
+}
+
+TEST_CASE("chart shifts samples in from the right while filling",
+          "[sh1106][chart]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  memset(s_handle.buffer, 0xA5, sizeof(s_handle.buffer));
+  TEST_ASSERT_EQUAL(ESP_OK,
+                    sh1106_chart_init(&s_chart, &s_handle, SH1106_CHART_BARS,
+                                      8, CHART_PAGE, 16, CHART_PAGES));
+  sh1106_chart_set_range(&s_chart, 0, CHART_ROWS - 1);
+
+  sh1106_chart_add(&s_chart, 3);
+  sh1106_chart_add(&s_chart, 7);
+  sh1106_chart_add(&s_chart, 11);
+
+  // A bar of value v covers v + 1 rows; columns with no sample are empty
+  for (uint8_t col = 0; col < 13; col++) {
+    TEST_ASSERT_EQUAL(0, column_height(col));
+  }
+  TEST_ASSERT_EQUAL(4, column_height(13));
+  TEST_ASSERT_EQUAL(8, column_height(14));
+  TEST_ASSERT_EQUAL(12, column_height(15));
+  expect_same_as_redraw();
+
+  // Columns around the chart are left alone
+  for (uint8_t p = CHART_PAGE; p < CHART_PAGE + CHART_PAGES; p++) {
+    TEST_ASSERT_EQUAL_HEX8(0xA5, s_handle.buffer[p][7]);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, s_handle.buffer[p][24]);
+  }
+}
+
+TEST_CASE("chart ring wraps and keeps matching a redraw", "[sh1106][chart]") {
+  static const sh1106_chart_style_t styles[] = {
+      SH1106_CHART_LINE, SH1106_CHART_BARS, SH1106_CHART_BAND};
+  const unsigned samples = 3 * SH1106_CHART_CAPACITY + 5;
+
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  for (size_t i = 0; i < sizeof(styles) / sizeof(styles[0]); i++) {
+    TEST_ASSERT_EQUAL(ESP_OK,
+                      sh1106_chart_init(&s_chart, &s_handle, styles[i], 0,
+                                        CHART_PAGE, SH1106_WIDTH,
+                                        CHART_PAGES));
+    sh1106_chart_set_range(&s_chart, 0, CHART_ROWS - 1);
+
+    for (unsigned n = 0; n < samples; n++) {
+      int16_t v = (n * 7) % CHART_ROWS;
+      sh1106_chart_add_range(&s_chart, v / 2, v);
+      expect_same_as_redraw();
+    }
+    TEST_ASSERT_EQUAL(SH1106_WIDTH + 1, s_chart.count);
+  }
+
+  // The bars show the last width samples, oldest on the left
+  TEST_ASSERT_EQUAL(ESP_OK,
+                    sh1106_chart_init(&s_chart, &s_handle, SH1106_CHART_BARS,
+                                      0, CHART_PAGE, SH1106_WIDTH,
+                                      CHART_PAGES));
+  sh1106_chart_set_range(&s_chart, 0, CHART_ROWS - 1);
+  for (unsigned n = 0; n < samples; n++) {
+    sh1106_chart_add(&s_chart, (n * 7) % CHART_ROWS);
+  }
+  for (uint8_t col = 0; col < SH1106_WIDTH; col++) {
+    unsigned n = samples - SH1106_WIDTH + col;
+    TEST_ASSERT_EQUAL((n * 7) % CHART_ROWS + 1, column_height(col));
+  }
+}
+
+TEST_CASE("chart autoscale grows at once and shrinks with hysteresis",
+          "[sh1106][chart]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK,
+                    sh1106_chart_init(&s_chart, &s_handle, SH1106_CHART_LINE,
+                                      0, CHART_PAGE, 4, CHART_PAGES));
+
+  sh1106_chart_add(&s_chart, 0);
+  sh1106_chart_add(&s_chart, 100);
+  TEST_ASSERT_EQUAL(0, s_chart.range_min);
+  TEST_ASSERT_EQUAL(100, s_chart.range_max);
+
+  // 0 and 100 scroll out, but the rest still spans at least half
+  sh1106_chart_add(&s_chart, 10);
+  sh1106_chart_add(&s_chart, 60);
+  sh1106_chart_add(&s_chart, 30);
+  sh1106_chart_add(&s_chart, 70);
+  TEST_ASSERT_EQUAL(0, s_chart.range_min);
+  TEST_ASSERT_EQUAL(100, s_chart.range_max);
+
+  // 60, 30, 70, 40 span less than half: fit to them
+  sh1106_chart_add(&s_chart, 40);
+  TEST_ASSERT_EQUAL(30, s_chart.range_min);
+  TEST_ASSERT_EQUAL(70, s_chart.range_max);
+
+  // A sample outside the range grows it right away
+  sh1106_chart_add(&s_chart, 75);
+  TEST_ASSERT_EQUAL(30, s_chart.range_min);
+  TEST_ASSERT_EQUAL(75, s_chart.range_max);
+  expect_same_as_redraw();
+
+  // A flat signal still gets a non-empty range
+  for (int i = 0; i < 4; i++) {
+    sh1106_chart_add(&s_chart, 50);
+  }
+  TEST_ASSERT_EQUAL(50, s_chart.range_min);
+  TEST_ASSERT_EQUAL(51, s_chart.range_max);
+}
@@ -0,0 +1,118 @@
+#include "sh1106.h"
+#include "sh1106_fx.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <string.h>
+
+#define FX_STEPS 5
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_fx_t s_fx;
+static uint8_t s_to[SH1106_PAGES][SH1106_WIDTH];
+
+static sh1106_fx_config_t fx_config(sh1106_fx_type_t type) {
+  sh1106_fx_config_t config = SH1106_FX_CONFIG_DEFAULT();
+  config.type = type;
+  config.duration_ms = FX_STEPS;
+  config.steps = FX_STEPS;
+  config.to = s_to;
+  return config;
+}
+
+#if SH1106_HEIGHT == 64
+
+static uint8_t s_from[SH1106_PAGES][SH1106_WIDTH];
+
+// Check the log from @p at for one step that moves the boundary from
+// @p old rows of the target to @p line: every page the boundary crossed,
+// built one row at a time, then the start line unless it is a wipe
+static size_t expect_step(size_t at, sh1106_fx_type_t type, uint8_t old,
+                          uint8_t line) {
+  static uint8_t expected[SH1106_WIDTH];
+  bool from_top = type != SH1106_FX_SLIDE_DOWN;
+  // RAM rows [lo, hi) switch to the target
+  uint8_t lo = from_top ? old : SH1106_HEIGHT - line;
+  uint8_t hi = from_top ? line : SH1106_HEIGHT - old;
+
+  for (uint8_t page = lo / 8; lo < hi && page <= (hi - 1) / 8; page++) {
+    for (uint8_t col = 0; col < SH1106_WIDTH; col++) {
+      expected[col] = 0;
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        uint8_t row = page * 8 + bit;
+        bool target = from_top ? row < line : row >= SH1106_HEIGHT - line;
+        uint8_t src = target ? s_to[page][col] : s_from[page][col];
+        expected[col] |= src & (1 << bit);
+      }
+    }
+    at = test_panel_expect_page_write(&s_panel, at, page, 0, 1, expected,
+                                      SH1106_WIDTH);
+  }
+
+  if (type != SH1106_FX_WIPE_DOWN) {
+    uint8_t start = from_top ? line : SH1106_HEIGHT - line;
+    TEST_ASSERT_EQUAL_HEX16(TEST_PANEL_CMD(0x40 | (start & 63)),
+                            s_panel.log[at]);
+    at++;
+  }
+  return at;
+}
+
+TEST_CASE("fx slides and wipes send the crossed pages and start lines",
+          "[sh1106][fx]") {
+  static const sh1106_fx_type_t types[] = {
+      SH1106_FX_SLIDE_UP, SH1106_FX_SLIDE_DOWN, SH1106_FX_WIPE_DOWN};
+
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    for (uint8_t col = 0; col < SH1106_WIDTH; col++) {
+      s_from[page][col] = (uint8_t)(page * 29 + col * 3 + 1);
+      s_to[page][col] = (uint8_t)~(page * 17 + col * 5);
+    }
+  }
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+    memcpy(s_handle.buffer, s_from, sizeof(s_from));
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+    test_panel_clear_log(&s_panel);
+
+    sh1106_fx_config_t config = fx_config(types[i]);
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_fx_start(&s_fx, &s_handle, &config));
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_fx_wait(&s_fx, portMAX_DELAY));
+
+    // Step s shows 64 * s / steps rows of the target: 12, 25, 38, 51, 64
+    size_t at = 0;
+    uint8_t old = 0;
+    for (uint16_t step = 1; step <= FX_STEPS; step++) {
+      uint8_t line = SH1106_HEIGHT * step / FX_STEPS;
+      at = expect_step(at, types[i], old, line);
+      old = line;
+    }
+    TEST_ASSERT_EQUAL(at, s_panel.log_len);
+
+    // The target is on the glass, unpanned, and is the new buffer
+    TEST_ASSERT_EQUAL(0, s_panel.start_line);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&s_to[0][0], &s_handle.buffer[0][0],
+                                 sizeof(s_to));
+    for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+      TEST_ASSERT_EQUAL_HEX8_ARRAY(s_to[page],
+                                   &s_panel.ram[page][SH1106_COLUMN_OFFSET],
+                                   SH1106_WIDTH);
+      TEST_ASSERT_GREATER_OR_EQUAL(s_handle.dirty_end[page],
+                                   s_handle.dirty_start[page]);
+    }
+  }
+}
+
+#else
+
+TEST_CASE("fx slides and wipes need a 64-row panel", "[sh1106][fx]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  test_panel_clear_log(&s_panel);
+  sh1106_fx_config_t config = fx_config(SH1106_FX_SLIDE_UP);
+  TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED,
+                    sh1106_fx_start(&s_fx, &s_handle, &config));
+  TEST_ASSERT_EQUAL(0, s_panel.log_len);
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "sh1106.h"
+#include "sh1106_image.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IMAGE_FILL 0xA5
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static uint8_t s_src[SH1106_HEIGHT][SH1106_WIDTH];
+static bool s_ref[SH1106_HEIGHT][SH1106_WIDTH];
+
+static const uint8_t s_bayer[8][8] = {
+    {0, 32, 8, 40, 2, 34, 10, 42},  {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44, 4, 36, 14, 46, 6, 38}, {60, 28, 52, 20, 62, 30, 54, 22},
+    {3, 35, 11, 43, 1, 33, 9, 41},  {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47, 7, 39, 13, 45, 5, 37}, {63, 31, 55, 23, 61, 29, 53, 21},
+};
+
+// The obvious quantizers: one pixel at a time, errors in whole sixteenths
+static void reference(const sh1106_image_config_t *cfg, uint8_t w,
+                      uint8_t h) {
+  static int32_t err[SH1106_WIDTH + 2];
+  static int32_t next[SH1106_WIDTH + 2];
+  memset(err, 0, sizeof(err));
+
+  for (uint8_t y = 0; y < h; y++) {
+    int32_t right = 0;
+    memset(next, 0, sizeof(next));
+
+    for (uint8_t x = 0; x < w; x++) {
+      int v = cfg->invert ? 255 - s_src[y][x] : s_src[y][x];
+      switch (cfg->dither) {
+      case SH1106_DITHER_BAYER:
+        s_ref[y][x] = v > 4 * s_bayer[y & 7][x & 7] + 2;
+        break;
+      case SH1106_DITHER_FLOYD_STEINBERG: {
+        int32_t total = v + err[x + 1] + right;
+        s_ref[y][x] = total > 127;
+        int32_t e = s_ref[y][x] ? total - 255 : total;
+        right = e * 7 / 16;
+        next[x] += e * 3; // Below left (x - 1, offset by one)
+        next[x + 1] += e * 5;
+        next[x + 2] += e;
+        break;
+      }
+      default:
+        s_ref[y][x] = v > cfg->threshold;
+        break;
+      }
+    }
+
+    for (uint8_t x = 0; x < w; x++) {
+      err[x + 1] = next[x + 1] / 16;
+    }
+  }
+}
+
+static void source_random(unsigned seed, uint8_t w, uint8_t h) {
+  srand(seed);
+  for (uint8_t y = 0; y < h; y++) {
+    for (uint8_t x = 0; x < w; x++) {
+      // Mostly noise, with rows of the extremes and a ramp
+      switch (y % 5) {
+      case 0:
+        s_src[y][x] = (x & 1) ? 255 : 0;
+        break;
+      case 1:
+        s_src[y][x] = (uint8_t)(x * 255 / (w > 1 ? w - 1 : 1));
+        break;
+      default:
+        s_src[y][x] = (uint8_t)rand();
+        break;
+      }
+    }
+  }
+}
+
+TEST_CASE("image quantizers match a per-pixel reference",
+          "[sh1106][image]") {
+  static const struct {
+    sh1106_dither_t dither;
+    uint8_t threshold;
+    bool invert;
+    uint8_t x, y, w, h;
+  } cases[] = {
+      {SH1106_DITHER_THRESHOLD, 127, false, 0, 0, SH1106_WIDTH, SH1106_HEIGHT},
+      {SH1106_DITHER_THRESHOLD, 0, false, 5, 3, 61, 21},
+      {SH1106_DITHER_THRESHOLD, 255, false, 0, 8, 64, 8},
+      {SH1106_DITHER_THRESHOLD, 200, true, 17, 9, 50, 19},
+      {SH1106_DITHER_BAYER, 0, false, 0, 0, SH1106_WIDTH, SH1106_HEIGHT},
+      {SH1106_DITHER_BAYER, 0, false, 3, 5, 63, 22},
+      {SH1106_DITHER_BAYER, 0, true, 64, 1, 33, 7},
+      {SH1106_DITHER_FLOYD_STEINBERG, 0, false, 0, 0, SH1106_WIDTH,
+       SH1106_HEIGHT},
+      {SH1106_DITHER_FLOYD_STEINBERG, 0, false, 7, 6, 1, 17},
+      {SH1106_DITHER_FLOYD_STEINBERG, 0, true, 30, 2, 45, 27},
+  };
+
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    uint8_t w = cases[i].w;
+    uint8_t h = cases[i].h;
+    sh1106_image_config_t cfg = {
+        .src_width = w,
+        .src_height = h,
+        .dst_x = cases[i].x,
+        .dst_y = cases[i].y,
+        .dither = cases[i].dither,
+        .scale = SH1106_SCALE_NONE,
+        .threshold = cases[i].threshold,
+        .invert = cases[i].invert,
+    };
+
+    source_random(i + 1, w, h);
+    reference(&cfg, w, h);
+    memset(s_handle.buffer, IMAGE_FILL, sizeof(s_handle.buffer));
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_image_draw(&s_handle, &cfg,
+                                                &s_src[0][0], SH1106_WIDTH));
+
+    for (uint8_t sy = 0; sy < SH1106_HEIGHT; sy++) {
+      for (uint8_t sx = 0; sx < SH1106_WIDTH; sx++) {
+        bool lit = (s_handle.buffer[sy / 8][sx] >> (sy % 8)) & 1;
+        bool inside = sx >= cfg.dst_x && sx < cfg.dst_x + w &&
+                      sy >= cfg.dst_y && sy < cfg.dst_y + h;
+        // Outside the image the fill pattern stays
+        bool expected = inside ? s_ref[sy - cfg.dst_y][sx - cfg.dst_x]
+                               : (IMAGE_FILL >> (sy % 8)) & 1;
+        if (lit != expected) {
+          char msg[64];
+          snprintf(msg, sizeof(msg), "case %u, pixel (%u, %u)", (unsigned)i,
+                   sx, sy);
+          TEST_FAIL_MESSAGE(msg);
+        }
+      }
+    }
+  }
+}
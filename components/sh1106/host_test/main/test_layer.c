@@ -0,0 +1,130 @@
+#include "sh1106.h"
+#include "sh1106_layer.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <string.h>
+
+#define BASE_FILL 0xA5
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_compositor_t s_comp;
+static sh1106_layer_t s_base;
+static sh1106_layer_t s_top;
+static uint8_t s_base_px[SH1106_LAYER_BUF_SIZE(SH1106_WIDTH, SH1106_HEIGHT)];
+static uint8_t s_top_px[SH1106_LAYER_BUF_SIZE(40, 16)];
+
+// Full-screen opaque base of BASE_FILL bytes, composited and sent
+static void base_init(void) {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_init(&s_comp, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_layer_init(&s_base, s_base_px,
+                                              SH1106_WIDTH, SH1106_HEIGHT));
+  memset(s_base_px, BASE_FILL, sizeof(s_base_px));
+  sh1106_layer_mark_dirty(&s_base, 0, 0, SH1106_WIDTH, SH1106_HEIGHT);
+  sh1106_layer_set_visible(&s_base, true);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_add(&s_comp, &s_base));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_render(&s_comp));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  test_panel_clear_log(&s_panel);
+}
+
+// Only [x, x + width) of pages [page, page + pages) are dirty
+static void expect_dirty(uint8_t x, uint8_t page, uint8_t width,
+                         uint8_t pages) {
+  for (uint8_t p = 0; p < SH1106_PAGES; p++) {
+    if (p >= page && p < page + pages) {
+      TEST_ASSERT_EQUAL(x, s_handle.dirty_start[p]);
+      TEST_ASSERT_EQUAL(x + width, s_handle.dirty_end[p]);
+    } else {
+      TEST_ASSERT_GREATER_OR_EQUAL(s_handle.dirty_end[p],
+                                   s_handle.dirty_start[p]);
+    }
+  }
+}
+
+TEST_CASE("layer popup damages and resends only its own area",
+          "[sh1106][layer]") {
+  base_init();
+
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_layer_init(&s_top, s_top_px, 40, 16));
+  sh1106_layer_fill_rect(&s_top, 2, 2, 36, 12, true);
+  sh1106_layer_set_position(&s_top, 30, 8);
+  sh1106_layer_set_visible(&s_top, true);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_add(&s_comp, &s_top));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_render(&s_comp));
+  expect_dirty(30, 1, 40, 2);
+
+  // Opaque: the popup's bytes replace the base under it
+  for (uint8_t p = 0; p < 2; p++) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&s_top_px[p * 40], &s_handle.buffer[1 + p][30],
+                                 40);
+    TEST_ASSERT_EQUAL_HEX8(BASE_FILL, s_handle.buffer[1 + p][29]);
+    TEST_ASSERT_EQUAL_HEX8(BASE_FILL, s_handle.buffer[1 + p][70]);
+  }
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(2, s_panel.page_calls);
+  TEST_ASSERT_EQUAL(0, test_panel_written_outside(&s_panel, 30, 1, 40, 2));
+
+  // Hiding it restores the base in the same area and nowhere else
+  test_panel_clear_log(&s_panel);
+  sh1106_layer_set_visible(&s_top, false);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_render(&s_comp));
+  expect_dirty(30, 1, 40, 2);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(0, test_panel_written_outside(&s_panel, 30, 1, 40, 2));
+  for (uint8_t p = 0; p < SH1106_PAGES; p++) {
+    for (uint8_t col = 0; col < SH1106_WIDTH; col++) {
+      TEST_ASSERT_EQUAL_HEX8(BASE_FILL, s_handle.buffer[p][col]);
+      TEST_ASSERT_EQUAL_HEX8(BASE_FILL,
+                             s_panel.ram[p][SH1106_COLUMN_OFFSET + col]);
+    }
+  }
+
+  // Nothing changed: nothing is damaged
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_render(&s_comp));
+  for (uint8_t p = 0; p < SH1106_PAGES; p++) {
+    TEST_ASSERT_GREATER_OR_EQUAL(s_handle.dirty_end[p],
+                                 s_handle.dirty_start[p]);
+  }
+}
+
+TEST_CASE("layer blend modes combine bytes across a page boundary",
+          "[sh1106][layer]") {
+  // An 8x8 layer at row 4 covers bits 4-7 of page 0 and 0-3 of page 1.
+  // Its rows 2-5 are set, so it lights bits 6-7 and 0-1 of those pages.
+  static const struct {
+    sh1106_blend_t blend;
+    uint8_t page0;
+    uint8_t page1;
+  } cases[] = {
+      {SH1106_BLEND_OPAQUE, 0xC5, 0xA3},
+      {SH1106_BLEND_OR, 0xE5, 0xA7},
+      {SH1106_BLEND_XOR, 0x65, 0xA6},
+      {SH1106_BLEND_MASK, 0x25, 0xA4},
+  };
+
+  base_init();
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_layer_init(&s_top, s_top_px, 8, 8));
+  sh1106_layer_fill_rect(&s_top, 0, 2, 8, 4, true);
+  sh1106_layer_set_position(&s_top, 16, 4);
+  sh1106_layer_set_visible(&s_top, true);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_add(&s_comp, &s_top));
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    sh1106_layer_set_blend(&s_top, cases[i].blend);
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_compositor_render(&s_comp));
+    for (uint8_t col = 16; col < 24; col++) {
+      TEST_ASSERT_EQUAL_HEX8(cases[i].page0, s_handle.buffer[0][col]);
+      TEST_ASSERT_EQUAL_HEX8(cases[i].page1, s_handle.buffer[1][col]);
+    }
+    TEST_ASSERT_EQUAL_HEX8(BASE_FILL, s_handle.buffer[0][15]);
+    TEST_ASSERT_EQUAL_HEX8(BASE_FILL, s_handle.buffer[1][24]);
+    TEST_ASSERT_EQUAL_HEX8(BASE_FILL, s_handle.buffer[2][16]);
+  }
+
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(0, test_panel_written_outside(&s_panel, 16, 0, 8, 2));
+  TEST_ASSERT_EQUAL_HEX8(0x25, s_panel.ram[0][SH1106_COLUMN_OFFSET + 16]);
+  TEST_ASSERT_EQUAL_HEX8(0xA4, s_panel.ram[1][SH1106_COLUMN_OFFSET + 16]);
+}
@@ -0,0 +1,119 @@
+#include "sh1106.h"
+#include "sh1106_list.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LIST_ITEMS 20
+#define LIST_ROWS 4
+#define LIST_WIDTH 64
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_list_t s_list;
+static unsigned s_get_calls;
+
+static uint32_t items_count(void *ctx) { return LIST_ITEMS; }
+
+static const char *items_get(uint32_t index, char *buf, size_t size,
+                             void *ctx) {
+  s_get_calls++;
+  snprintf(buf, size, "Item %u", (unsigned)index);
+  return buf;
+}
+
+static const sh1106_list_provider_t s_provider = {
+    .count = items_count,
+    .get_item = items_get,
+};
+
+// Incremental updates must leave the same pixels as a full redraw
+static void expect_same_as_refresh(void) {
+  static uint8_t moved[SH1106_PAGES][SH1106_WIDTH];
+  memcpy(moved, s_handle.buffer, sizeof(moved));
+  sh1106_list_refresh(&s_list);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(&moved[0][0], &s_handle.buffer[0][0],
+                               sizeof(moved));
+}
+
+static bool row_dirty(uint8_t row) {
+  return s_handle.dirty_end[row] > s_handle.dirty_start[row];
+}
+
+static void list_init(void) {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK,
+                    sh1106_list_init(&s_list, &s_handle, &s_provider,
+                                     FONT_8X8_DEFAULT, 0, 0, LIST_WIDTH,
+                                     LIST_ROWS));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+  test_panel_clear_log(&s_panel);
+  s_get_calls = 0;
+}
+
+TEST_CASE("list moves the highlight by redrawing two rows",
+          "[sh1106][list]") {
+  list_init();
+  static uint8_t before[SH1106_PAGES][SH1106_WIDTH];
+  memcpy(before, s_handle.buffer, sizeof(before));
+
+  sh1106_list_move(&s_list, 2);
+  TEST_ASSERT_EQUAL(2, s_list.selected);
+  TEST_ASSERT_EQUAL(0, s_list.top);
+  TEST_ASSERT_EQUAL(0, s_get_calls);
+
+  // Rows 0 and 2 swap their inversion, rows 1 and 3 are untouched
+  TEST_ASSERT_TRUE(row_dirty(0));
+  TEST_ASSERT_FALSE(row_dirty(1));
+  TEST_ASSERT_TRUE(row_dirty(2));
+  TEST_ASSERT_FALSE(row_dirty(3));
+  for (uint8_t col = 0; col < LIST_WIDTH; col++) {
+    TEST_ASSERT_EQUAL_HEX8(before[0][col] ^ 0xFF, s_handle.buffer[0][col]);
+    TEST_ASSERT_EQUAL_HEX8(before[2][col] ^ 0xFF, s_handle.buffer[2][col]);
+  }
+
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(2, s_panel.page_calls);
+  TEST_ASSERT_EQUAL(0,
+                    test_panel_written_outside(&s_panel, 0, 0, LIST_WIDTH, 3));
+  for (uint8_t col = 0; col < SH1106_RAM_COLUMNS; col++) {
+    TEST_ASSERT_EQUAL(0, s_panel.written[1][col]);
+  }
+  expect_same_as_refresh();
+}
+
+TEST_CASE("list scrolling shifts rows and fixes up the highlight",
+          "[sh1106][list]") {
+  list_init();
+  sh1106_list_select(&s_list, LIST_ROWS - 1);
+  s_get_calls = 0;
+
+  // One row down past the bottom: the new row is the only one fetched
+  sh1106_list_move(&s_list, 1);
+  TEST_ASSERT_EQUAL(LIST_ROWS, s_list.selected);
+  TEST_ASSERT_EQUAL(1, s_list.top);
+  TEST_ASSERT_EQUAL(1, s_get_calls);
+  expect_same_as_refresh();
+
+  // Back up past the top, then two rows up at once
+  sh1106_list_move(&s_list, -4);
+  TEST_ASSERT_EQUAL(0, s_list.top);
+  expect_same_as_refresh();
+  sh1106_list_select(&s_list, 10);
+  sh1106_list_move(&s_list, -8);
+  TEST_ASSERT_EQUAL(2, s_list.selected);
+  TEST_ASSERT_EQUAL(2, s_list.top);
+  expect_same_as_refresh();
+
+  // Moves past either end stop at the first and last item
+  sh1106_list_move(&s_list, INT32_MAX);
+  TEST_ASSERT_EQUAL(LIST_ITEMS - 1, s_list.selected);
+  TEST_ASSERT_EQUAL(LIST_ITEMS - LIST_ROWS, s_list.top);
+  expect_same_as_refresh();
+  sh1106_list_move(&s_list, INT32_MIN);
+  TEST_ASSERT_EQUAL(0, s_list.selected);
+  TEST_ASSERT_EQUAL(0, s_list.top);
+  expect_same_as_refresh();
+}
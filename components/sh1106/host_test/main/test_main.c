@@ -0,0 +1,16 @@
+#include "sdkconfig.h"
+#include "unity.h"
+#include <stdlib.h>
+
+void app_main(void) {
+  UNITY_BEGIN();
+  unity_run_all_tests();
+  int failures = UNITY_END();
+
+#if CONFIG_IDF_TARGET_LINUX
+  // Report the result through the process exit status
+  exit(failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+#else
+  (void)failures;
+#endif
+}
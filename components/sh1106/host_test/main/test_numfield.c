@@ -0,0 +1,88 @@
+#include "sh1106.h"
+#include "sh1106_numfield.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <math.h>
+#include <string.h>
+
+#define FIELD_X 20
+#define FIELD_PAGE 2
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_numfield_t s_field;
+
+static const uint8_t *glyph(char c) {
+  const sh1106_font_t *font = sh1106_get_font(FONT_8X8_DEFAULT);
+  return font->data + (uint8_t)(c - font->first_char) * font->width;
+}
+
+// The field's buffer cells read @p text
+static void expect_cells(const char *text) {
+  for (uint8_t i = 0; text[i] != '\0'; i++) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(
+        glyph(text[i]), &s_handle.buffer[FIELD_PAGE][s_field.x + i * 8], 8);
+  }
+}
+
+TEST_CASE("numfield redraws and sends only the changed digit",
+          "[sh1106][numfield]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK,
+                    sh1106_numfield_init(&s_field, &s_handle, FONT_8X8_DEFAULT,
+                                         FIELD_X, FIELD_PAGE, 5));
+  sh1106_numfield_set_int(&s_field, 1234);
+  expect_cells(" 1234");
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  test_panel_clear_log(&s_panel);
+
+  // Only the last cell changes, so only its columns are dirty
+  sh1106_numfield_set_int(&s_field, 1235);
+  const uint8_t cell = FIELD_X + 4 * 8;
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    if (page == FIELD_PAGE) {
+      TEST_ASSERT_EQUAL(cell, s_handle.dirty_start[page]);
+      TEST_ASSERT_EQUAL(cell + 8, s_handle.dirty_end[page]);
+    } else {
+      TEST_ASSERT_GREATER_OR_EQUAL(s_handle.dirty_end[page],
+                                   s_handle.dirty_start[page]);
+    }
+  }
+
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(1, s_panel.page_calls);
+  TEST_ASSERT_EQUAL(0, test_panel_written_outside(&s_panel, cell, FIELD_PAGE,
+                                                  8, 1));
+  for (uint8_t i = 0; i < 8; i++) {
+    TEST_ASSERT_EQUAL(
+        1, s_panel.written[FIELD_PAGE][SH1106_COLUMN_OFFSET + cell + i]);
+  }
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(
+      glyph('5'), &s_panel.ram[FIELD_PAGE][SH1106_COLUMN_OFFSET + cell], 8);
+
+  // The same value again changes nothing
+  test_panel_clear_log(&s_panel);
+  sh1106_numfield_set_int(&s_field, 1235);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(0, s_panel.page_calls);
+}
+
+TEST_CASE("numfield float range ends below 2^32", "[sh1106][numfield]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK,
+                    sh1106_numfield_init(&s_field, &s_handle, FONT_8X8_DEFAULT,
+                                         0, FIELD_PAGE, 10));
+
+  // The largest float below 2^32
+  sh1106_numfield_set_float(&s_field, 4294967040.0f, 0);
+  expect_cells("4294967040");
+
+  sh1106_numfield_set_float(&s_field, 4294967296.0f, 0);
+  expect_cells("##########");
+
+  sh1106_numfield_set_float(&s_field, -2.5f, 1);
+  expect_cells("      -2.5");
+
+  sh1106_numfield_set_float(&s_field, NAN, 1);
+  expect_cells("##########");
+}
@@ -0,0 +1,260 @@
+#include "test_panel.h"
+#include "esp_timer.h"
+#include "unity.h"
+#include <string.h>
+
+static void panel_log(test_panel_t *panel, const uint8_t *bytes, size_t len,
+                      uint16_t dc) {
+  for (size_t i = 0; i < len; i++) {
+    if (panel->log_len < TEST_PANEL_LOG_SIZE) {
+      panel->log[panel->log_len++] = dc | bytes[i];
+    } else {
+      panel->log_dropped++;
+    }
+  }
+}
+
+// Arguments taken by a command byte, for the commands the driver sends
+static uint8_t panel_arg_count(uint8_t cmd) {
+  switch (cmd) {
+  case SH1106_CMD_SET_CONTRAST:
+  case SH1106_CMD_SET_MULTIPLEX:
+  case SH1106_CMD_SET_DISPLAY_OFFSET:
+  case SH1106_CMD_SET_CLOCK_DIV:
+  case SH1106_CMD_SET_PRECHARGE:
+  case SH1106_CMD_SET_COM_PINS:
+  case SH1106_CMD_SET_VCOM_DESELECT:
+  case SH1106_CMD_SET_CHARGE_PUMP:
+    return 1;
+#if SH1106_CONTROLLER_SSD1306
+  case SH1106_CMD_SET_MEMORY_MODE:
+    return 1;
+  case SH1106_CMD_SET_COLUMN_RANGE:
+  case SH1106_CMD_SET_PAGE_RANGE:
+    return 2;
+#endif
+  default:
+    return 0;
+  }
+}
+
+static void panel_command(test_panel_t *panel, const uint8_t *cmd) {
+  uint8_t c = cmd[0];
+
+  if (c <= 0x0F) {
+    panel->col = (panel->col & 0xF0) | c;
+    return;
+  }
+  if (c <= 0x1F) {
+    panel->col = (panel->col & 0x0F) | ((c & 0x0F) << 4);
+    return;
+  }
+  if ((c & 0xF8) == SH1106_CMD_SET_PAGE_ADDR) {
+    panel->page = c & 0x07;
+    return;
+  }
+  if ((c & 0xC0) == SH1106_CMD_SET_START_LINE) {
+    panel->start_line = c & 0x3F;
+    return;
+  }
+
+  switch (c) {
+  case SH1106_CMD_SET_CONTRAST:
+    panel->contrast = cmd[1];
+    break;
+  case SH1106_CMD_SET_SEGMENT_REMAP:
+  case SH1106_CMD_SET_SEGMENT_NORMAL:
+    panel->segment_remap = c == SH1106_CMD_SET_SEGMENT_REMAP;
+    break;
+  case SH1106_CMD_SET_SCAN_DIRECTION:
+  case SH1106_CMD_SET_SCAN_NORMAL:
+    panel->scan_remap = c == SH1106_CMD_SET_SCAN_DIRECTION;
+    break;
+  case SH1106_CMD_DISPLAY_ON:
+  case SH1106_CMD_DISPLAY_OFF:
+    panel->display_on = c == SH1106_CMD_DISPLAY_ON;
+    break;
+#if SH1106_CONTROLLER_SSD1306
+  case SH1106_CMD_SET_MEMORY_MODE:
+    panel->horizontal = cmd[1] == 0x00;
+    break;
+  case SH1106_CMD_SET_COLUMN_RANGE:
+    panel->col_start = cmd[1];
+    panel->col_end = cmd[2];
+    panel->col = cmd[1];
+    break;
+  case SH1106_CMD_SET_PAGE_RANGE:
+    panel->page_start = cmd[1];
+    panel->page_end = cmd[2];
+    panel->page = cmd[1];
+    break;
+#endif
+  default:
+    break;
+  }
+}
+
+static void panel_commands(test_panel_t *panel, const uint8_t *cmds,
+                           size_t len) {
+  for (size_t i = 0; i < len; i += 1 + panel_arg_count(cmds[i])) {
+    if (i + panel_arg_count(cmds[i]) >= len) {
+      break; // Truncated command; the log still shows it
+    }
+    panel_command(panel, &cmds[i]);
+  }
+}
+
+static void panel_data(test_panel_t *panel, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (panel->page < SH1106_PAGES && panel->col < SH1106_RAM_COLUMNS) {
+      panel->ram[panel->page][panel->col] = data[i];
+      panel->written[panel->page][panel->col]++;
+    }
+
+    if (panel->horizontal && panel->col == panel->col_end) {
+      // The window wraps to its first column on the next page
+      panel->col = panel->col_start;
+      panel->page = panel->page == panel->page_end ? panel->page_start
+                                                   : panel->page + 1;
+    } else {
+      panel->col++;
+    }
+  }
+}
+
+static esp_err_t panel_write_cmds(void *ctx, const uint8_t *cmds,
+                                  size_t len) {
+  test_panel_t *panel = (test_panel_t *)ctx;
+  panel->cmd_calls++;
+  if (panel->fail != ESP_OK) {
+    return panel->fail;
+  }
+
+  panel_log(panel, cmds, len, 0);
+  panel_commands(panel, cmds, len);
+  return ESP_OK;
+}
+
+static esp_err_t panel_write_page(void *ctx, const uint8_t *cmds,
+                                  size_t cmd_len, const uint8_t *data,
+                                  size_t len) {
+  test_panel_t *panel = (test_panel_t *)ctx;
+  panel->page_calls++;
+  if (panel->fail != ESP_OK) {
+    return panel->fail;
+  }
+  if (panel->stall_us != 0) {
+    // Hold the caller like a slow bus would
+    int64_t until = esp_timer_get_time() + panel->stall_us;
+    panel->stall_us = 0;
+    while (esp_timer_get_time() < until) {
+    }
+  }
+
+  panel_log(panel, cmds, cmd_len, 0);
+  panel_commands(panel, cmds, cmd_len);
+  panel_log(panel, data, len, TEST_PANEL_DATA);
+  panel_data(panel, data, len);
+  return ESP_OK;
+}
+
+void test_panel_feed(test_panel_t *panel, const uint8_t *bytes, size_t len,
+                     bool data) {
+  if (data) {
+    panel_log(panel, bytes, len, TEST_PANEL_DATA);
+    panel_data(panel, bytes, len);
+    return;
+  }
+
+  panel_log(panel, bytes, len, 0);
+  for (size_t i = 0; i < len; i++) {
+    panel->cmd_buf[panel->cmd_len++] = bytes[i];
+    if (panel->cmd_len > panel_arg_count(panel->cmd_buf[0])) {
+      panel_command(panel, panel->cmd_buf);
+      panel->cmd_len = 0;
+    }
+  }
+}
+
+const sh1106_transport_t test_panel_transport = {
+    .write_cmds = panel_write_cmds,
+    .write_page = panel_write_page,
+    .wait = NULL,
+};
+
+void test_panel_reset(test_panel_t *panel) {
+  memset(panel, 0, sizeof(*panel));
+  panel->fail = ESP_OK;
+  panel->col_end = SH1106_RAM_COLUMNS - 1;
+  panel->page_end = SH1106_PAGES - 1;
+  panel->contrast = 0x80;
+}
+
+void test_panel_clear_log(test_panel_t *panel) {
+  panel->log_len = 0;
+  panel->log_dropped = 0;
+  panel->cmd_calls = 0;
+  panel->page_calls = 0;
+  memset(panel->written, 0, sizeof(panel->written));
+}
+
+esp_err_t test_panel_init(test_panel_t *panel, sh1106_handle_t *handle) {
+  test_panel_reset(panel);
+  memset(handle, 0, sizeof(*handle));
+  return sh1106_init_transport(handle, &test_panel_transport, panel);
+}
+
+size_t test_panel_expect_page_write(const test_panel_t *panel, size_t at,
+                                    uint8_t page, uint8_t col, uint8_t pages,
+                                    const uint8_t *data, size_t len) {
+  uint8_t ram_col = col + SH1106_COLUMN_OFFSET;
+#if SH1106_CONTROLLER_SSD1306
+  const uint16_t cmds[] = {
+      TEST_PANEL_CMD(0x21), TEST_PANEL_CMD(ram_col),
+      TEST_PANEL_CMD(ram_col + len / pages - 1), TEST_PANEL_CMD(0x22),
+      TEST_PANEL_CMD(page), TEST_PANEL_CMD(page + pages - 1),
+  };
+#else
+  const uint16_t cmds[] = {
+      TEST_PANEL_CMD(0xB0 | page),
+      TEST_PANEL_CMD(0x00 | (ram_col & 0x0F)),
+      TEST_PANEL_CMD(0x10 | (ram_col >> 4)),
+  };
+#endif
+
+  TEST_ASSERT_LESS_OR_EQUAL(panel->log_len,
+                            at + sizeof(cmds) / sizeof(cmds[0]) + len);
+  TEST_ASSERT_EQUAL_HEX16_ARRAY(cmds, &panel->log[at],
+                                sizeof(cmds) / sizeof(cmds[0]));
+  at += sizeof(cmds) / sizeof(cmds[0]);
+  for (size_t i = 0; i < len; i++) {
+    TEST_ASSERT_EQUAL_HEX16(TEST_PANEL_DAT(data[i]), panel->log[at + i]);
+  }
+  return at + len;
+}
+
+unsigned test_panel_written_outside(const test_panel_t *panel, uint8_t x,
+                                    uint8_t page, uint8_t width,
+                                    uint8_t pages) {
+  unsigned outside = 0;
+  for (uint8_t p = 0; p < SH1106_PAGES; p++) {
+    for (uint8_t col = 0; col < SH1106_RAM_COLUMNS; col++) {
+      bool inside = p >= page && p < page + pages &&
+                    col >= SH1106_COLUMN_OFFSET + x &&
+                    col < SH1106_COLUMN_OFFSET + x + width;
+      if (!inside) {
+        outside += panel->written[p][col];
+      }
+    }
+  }
+  return outside;
+}
+
+bool test_panel_pixel(const test_panel_t *panel, uint8_t x, uint8_t y) {
+  // The init sequence remaps both directions; that is the upright picture
+  uint8_t col = panel->segment_remap
+                    ? SH1106_COLUMN_OFFSET + x
+                    : SH1106_RAM_COLUMNS - 1 - SH1106_COLUMN_OFFSET - x;
+  uint8_t row = panel->scan_remap ? y : SH1106_HEIGHT - 1 - y;
+  return (panel->ram[row / 8][col] >> (row % 8)) & 1;
+}
@@ -0,0 +1,134 @@
+#ifndef TEST_PANEL_H
+#define TEST_PANEL_H
+
+#include "sh1106.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes kept in the transport log; later bytes are counted but dropped
+#define TEST_PANEL_LOG_SIZE 4096
+
+// Bit 8 of a log entry is the D/C level the byte was sent with
+#define TEST_PANEL_DATA 0x100
+#define TEST_PANEL_CMD(byte) ((uint16_t)(byte))
+#define TEST_PANEL_DAT(byte) ((uint16_t)(TEST_PANEL_DATA | (byte)))
+
+// Stub transport that records the exact byte and D/C sequence and models
+// the controller's display RAM, so tests can check both what went over the
+// bus and what the glass would show.
+typedef struct {
+  uint16_t log[TEST_PANEL_LOG_SIZE];
+  size_t log_len;      // Entries in log
+  size_t log_dropped;  // Bytes sent after the log filled up
+  unsigned cmd_calls;  // write_cmds() calls
+  unsigned page_calls; // write_page() calls
+  esp_err_t fail;      // Returned by every hook when not ESP_OK
+  uint32_t stall_us;   // Next write_page() busy-waits this long, then clears
+
+  // Controller state
+  uint8_t ram[SH1106_PAGES][SH1106_RAM_COLUMNS];
+  uint8_t page;
+  uint8_t col;
+  bool horizontal; // SSD1306 horizontal addressing and its window
+  uint8_t col_start, col_end;
+  uint8_t page_start, page_end;
+  bool segment_remap; // 0xA1: RAM column 0 at the right edge
+  bool scan_remap;    // 0xC8: COM scan from the bottom up
+  uint8_t contrast;
+  uint8_t start_line; // RAM row shown at the top
+  bool display_on;
+  uint8_t cmd_buf[3]; // Command bytes fed so far (see test_panel_feed())
+  uint8_t cmd_len;
+  // Data bytes written to each RAM byte since the log was cleared
+  uint8_t written[SH1106_PAGES][SH1106_RAM_COLUMNS];
+} test_panel_t;
+
+extern const sh1106_transport_t test_panel_transport;
+
+/**
+ * @brief Reset the log and the controller model to power-on state
+ *
+ * @param panel Panel to reset
+ */
+void test_panel_reset(test_panel_t *panel);
+
+/**
+ * @brief Forget the logged bytes, keeping the controller state
+ *
+ * @param panel Panel whose log to clear
+ */
+void test_panel_clear_log(test_panel_t *panel);
+
+/**
+ * @brief Reset the panel and initialize a handle on it
+ *
+ * @param panel Panel to use as the transport context
+ * @param handle Handle to initialize
+ * @return esp_err_t Result of sh1106_init_transport()
+ */
+esp_err_t test_panel_init(test_panel_t *panel, sh1106_handle_t *handle);
+
+/**
+ * @brief Deliver bus bytes to the panel model
+ *
+ * For fake buses that send a command in several pieces, as the SPI
+ * transport does with address runs longer than one descriptor. The bytes
+ * are logged like the stub transport logs them.
+ *
+ * @param panel Panel to feed
+ * @param bytes Bytes as they appear on the bus
+ * @param len Number of bytes
+ * @param data D/C level: true for display data, false for commands
+ */
+void test_panel_feed(test_panel_t *panel, const uint8_t *bytes, size_t len,
+                     bool data);
+
+/**
+ * @brief Check the log for one page write
+ *
+ * Expects the address commands the driver sends for a write of @p len
+ * bytes to @p pages pages from (@p col, @p page), then the data bytes.
+ *
+ * @param panel Panel whose log to check
+ * @param at Log index the write starts at
+ * @param page First page
+ * @param col First visible column
+ * @param pages Pages the write covers (SSD1306 windows)
+ * @param data Expected data bytes
+ * @param len Number of data bytes
+ * @return size_t Log index after the write
+ */
+size_t test_panel_expect_page_write(const test_panel_t *panel, size_t at,
+                                    uint8_t page, uint8_t col, uint8_t pages,
+                                    const uint8_t *data, size_t len);
+
+/**
+ * @brief Count RAM bytes written outside a rectangle since the log was
+ * cleared
+ *
+ * @param panel Panel to check
+ * @param x Left visible column of the rectangle
+ * @param page First page of the rectangle
+ * @param width Width in columns
+ * @param pages Height in pages
+ * @return unsigned Bytes written outside the rectangle
+ */
+unsigned test_panel_written_outside(const test_panel_t *panel, uint8_t x,
+                                    uint8_t page, uint8_t width,
+                                    uint8_t pages);
+
+/**
+ * @brief Pixel the glass shows, in the orientation of rotation 0
+ *
+ * Applies the visible column window and the segment and scan flips, so a
+ * 180 degree rotation reads back the same as 0 for the same image.
+ *
+ * @param panel Panel to read
+ * @param x Visible column (0 to SH1106_WIDTH - 1)
+ * @param y Row (0 to SH1106_HEIGHT - 1)
+ * @return true if the pixel is lit
+ */
+bool test_panel_pixel(const test_panel_t *panel, uint8_t x, uint8_t y);
+
+#endif // TEST_PANEL_H
@@ -0,0 +1,173 @@
+#include "esp_timer.h"
+#include "sh1106.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_FRAMES 2000
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+
+// Logical canvas access: page-major with rows handle->width bytes long, in
+// both orientations
+static uint8_t *canvas_byte(sh1106_handle_t *handle, uint8_t x, uint8_t y) {
+  return &handle->buffer[0][0] + (size_t)(y / 8) * handle->width + x;
+}
+
+static bool canvas_pixel(sh1106_handle_t *handle, uint8_t x, uint8_t y) {
+  return (*canvas_byte(handle, x, y) >> (y % 8)) & 1;
+}
+
+static void canvas_random(sh1106_handle_t *handle, unsigned seed) {
+  srand(seed);
+  for (size_t i = 0; i < sizeof(handle->buffer); i++) {
+    (&handle->buffer[0][0])[i] = (uint8_t)rand();
+  }
+  sh1106_mark_dirty(handle, 0, 0, handle->width, handle->height / 8);
+}
+
+// Where a logical pixel must appear on the glass, as seen at rotation 0
+static void glass_position(sh1106_rotation_t rotation, uint8_t lx, uint8_t ly,
+                           uint8_t *gx, uint8_t *gy) {
+  switch (rotation) {
+  case SH1106_ROTATION_90:
+    *gx = SH1106_WIDTH - 1 - ly;
+    *gy = lx;
+    break;
+  case SH1106_ROTATION_180:
+    *gx = SH1106_WIDTH - 1 - lx;
+    *gy = SH1106_HEIGHT - 1 - ly;
+    break;
+  case SH1106_ROTATION_270:
+    *gx = ly;
+    *gy = SH1106_HEIGHT - 1 - lx;
+    break;
+  default:
+    *gx = lx;
+    *gy = ly;
+    break;
+  }
+}
+
+// Compare every logical pixel with the glass, one pixel at a time
+static void expect_glass(sh1106_handle_t *handle) {
+  for (uint8_t ly = 0; ly < handle->height; ly++) {
+    for (uint8_t lx = 0; lx < handle->width; lx++) {
+      uint8_t gx, gy;
+      glass_position(handle->rotation, lx, ly, &gx, &gy);
+      if (canvas_pixel(handle, lx, ly) != test_panel_pixel(&s_panel, gx, gy)) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "rotation %d, logical (%u, %u)",
+                 handle->rotation, lx, ly);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+  }
+}
+
+TEST_CASE("all rotations match a per-pixel reference", "[sh1106][rotate]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+
+  for (int rotation = SH1106_ROTATION_0; rotation <= SH1106_ROTATION_270;
+       rotation++) {
+    esp_err_t ret = sh1106_set_rotation(&s_handle, rotation);
+    if (SH1106_WIDTH % 8 != 0 && (rotation & 1)) {
+      TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, ret);
+      continue;
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+
+    // Full frame
+    canvas_random(&s_handle, rotation);
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+    expect_glass(&s_handle);
+
+    // A block that straddles tile and page edges, sent as dirty spans
+    for (uint8_t y = 5; y < 21; y++) {
+      for (uint8_t x = 3; x < 14; x++) {
+        *canvas_byte(&s_handle, x, y) ^= 1 << (y % 8);
+      }
+    }
+    sh1106_mark_dirty(&s_handle, 3, 0, 11, 3);
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+    expect_glass(&s_handle);
+  }
+}
+
+static esp_err_t null_write_cmds(void *ctx, const uint8_t *cmds,
+                                 size_t len) {
+  return ESP_OK;
+}
+
+static esp_err_t null_write_page(void *ctx, const uint8_t *cmds,
+                                 size_t cmd_len, const uint8_t *data,
+                                 size_t len) {
+  // Keep the converted bytes observable
+  *(volatile uint8_t *)ctx ^= data[len - 1];
+  return ESP_OK;
+}
+
+static const sh1106_transport_t s_null_transport = {
+    .write_cmds = null_write_cmds,
+    .write_page = null_write_page,
+};
+
+// The obvious conversion for 90 degrees: move one pixel at a time
+static void naive_portrait_frame(const uint8_t *canvas,
+                                 uint8_t out[SH1106_PAGES][SH1106_WIDTH]) {
+  memset(out, 0, SH1106_PAGES * SH1106_WIDTH);
+  for (uint8_t ly = 0; ly < SH1106_WIDTH; ly++) {
+    for (uint8_t lx = 0; lx < SH1106_HEIGHT; lx++) {
+      if ((canvas[(ly / 8) * SH1106_HEIGHT + lx] >> (ly % 8)) & 1) {
+        uint8_t x = SH1106_WIDTH - 1 - ly;
+        out[lx / 8][x] |= 1 << (lx % 8);
+      }
+    }
+  }
+}
+
+static uint32_t bench_update(sh1106_handle_t *handle) {
+  int64_t start = esp_timer_get_time();
+  for (int i = 0; i < BENCH_FRAMES; i++) {
+    sh1106_update_display(handle);
+  }
+  return (uint32_t)((esp_timer_get_time() - start) * 1000 / BENCH_FRAMES);
+}
+
+TEST_CASE("portrait transpose throughput", "[sh1106][rotate][bench]") {
+  static uint8_t out[SH1106_PAGES][SH1106_WIDTH];
+  volatile uint8_t sink = 0;
+
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_init_transport(
+                                &s_handle, &s_null_transport, (void *)&sink));
+  if (sh1106_set_rotation(&s_handle, SH1106_ROTATION_90) != ESP_OK) {
+    return; // No portrait on this panel
+  }
+  canvas_random(&s_handle, 1);
+
+  // Landscape costs the same bus calls without the transposes
+  uint32_t portrait_ns = bench_update(&s_handle);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_set_rotation(&s_handle, SH1106_ROTATION_0));
+  canvas_random(&s_handle, 1);
+  uint32_t landscape_ns = bench_update(&s_handle);
+
+  int64_t start = esp_timer_get_time();
+  for (int i = 0; i < BENCH_FRAMES; i++) {
+    naive_portrait_frame(&s_handle.buffer[0][0], out);
+    sink ^= out[i % SH1106_PAGES][i % SH1106_WIDTH];
+  }
+  uint32_t naive_ns =
+      (uint32_t)((esp_timer_get_time() - start) * 1000 / BENCH_FRAMES);
+
+  uint32_t tiles = SH1106_PAGES * SH1106_WIDTH / 8;
+  uint32_t transpose_ns =
+      portrait_ns > landscape_ns ? portrait_ns - landscape_ns : 0;
+  printf("portrait frame %lu ns, landscape frame %lu ns\n",
+         (unsigned long)portrait_ns, (unsigned long)landscape_ns);
+  printf("transposes %lu ns per frame, %lu ns per 8x8 tile\n",
+         (unsigned long)transpose_ns, (unsigned long)(transpose_ns / tiles));
+  printf("per-pixel reference %lu ns per frame\n", (unsigned long)naive_ns);
+}
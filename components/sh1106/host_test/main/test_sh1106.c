@@ -0,0 +1,137 @@
+#include "sh1106.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <string.h>
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+
+// Expected power-up stream for the configured panel
+static const uint8_t s_init_table[] = {
+    0xAE,       // Display off
+    0xD5, 0x80, // Clock divide
+    0xA8, SH1106_HEIGHT - 1,
+    0xD3, 0x00, // Display offset
+    0x40,       // Start line 0
+    0x8D, 0x14, // Charge pump on
+#if SH1106_CONTROLLER_SSD1306
+    0x20, 0x00, // Horizontal addressing
+#endif
+    0xA1, 0xC8, // Segment and COM scan remapped
+    0xDA, SH1106_HEIGHT == 32 ? 0x02 : 0x12,
+    0x81, SH1106_HEIGHT == 32 ? 0x8F : 0xCF,
+    0xD9, 0xF1, // Precharge
+    0xDB, 0x40, // VCOM deselect
+    0xA4, 0xA6, // RAM content, not inverted
+    0xAF,       // Display on
+};
+
+static void fill_pattern(sh1106_handle_t *handle) {
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    for (uint8_t col = 0; col < SH1106_WIDTH; col++) {
+      handle->buffer[page][col] = (uint8_t)(page * 37 + col * 11 + 1);
+    }
+  }
+}
+
+TEST_CASE("init sends the panel init table as commands", "[sh1106]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+
+  TEST_ASSERT_EQUAL(1, s_panel.cmd_calls);
+  TEST_ASSERT_EQUAL(0, s_panel.page_calls);
+  TEST_ASSERT_EQUAL(sizeof(s_init_table), s_panel.log_len);
+  for (size_t i = 0; i < sizeof(s_init_table); i++) {
+    TEST_ASSERT_EQUAL_HEX16(TEST_PANEL_CMD(s_init_table[i]), s_panel.log[i]);
+  }
+
+  TEST_ASSERT_TRUE(s_panel.display_on);
+  TEST_ASSERT_TRUE(s_panel.segment_remap);
+  TEST_ASSERT_TRUE(s_panel.scan_remap);
+  TEST_ASSERT_EQUAL(SH1106_WIDTH, s_handle.width);
+  TEST_ASSERT_EQUAL(SH1106_HEIGHT, s_handle.height);
+}
+
+TEST_CASE("init rejects a transport without page writes", "[sh1106]") {
+  static const sh1106_transport_t incomplete = {
+      .write_cmds = NULL,
+      .write_page = NULL,
+  };
+  TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                    sh1106_init_transport(&s_handle, &incomplete, NULL));
+}
+
+TEST_CASE("full update addresses every page and sends the buffer",
+          "[sh1106]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  fill_pattern(&s_handle);
+  test_panel_clear_log(&s_panel);
+
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+  TEST_ASSERT_EQUAL(0, s_panel.log_dropped);
+
+#if SH1106_CONTROLLER_SSD1306
+  // One horizontal-addressing window for the whole frame
+  TEST_ASSERT_EQUAL(1, s_panel.page_calls);
+  size_t at = test_panel_expect_page_write(&s_panel, 0, 0, 0, SH1106_PAGES,
+                                           &s_handle.buffer[0][0],
+                                           sizeof(s_handle.buffer));
+#else
+  TEST_ASSERT_EQUAL(SH1106_PAGES, s_panel.page_calls);
+  size_t at = 0;
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    at = test_panel_expect_page_write(&s_panel, at, page, 0, 1,
+                                      s_handle.buffer[page], SH1106_WIDTH);
+  }
+#endif
+  TEST_ASSERT_EQUAL(at, s_panel.log_len);
+}
+
+TEST_CASE("panel RAM matches the buffer after a full update", "[sh1106]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  fill_pattern(&s_handle);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+
+  for (uint8_t y = 0; y < SH1106_HEIGHT; y++) {
+    for (uint8_t x = 0; x < SH1106_WIDTH; x++) {
+      bool lit = (s_handle.buffer[y / 8][x] >> (y % 8)) & 1;
+      TEST_ASSERT_EQUAL(lit, test_panel_pixel(&s_panel, x, y));
+    }
+  }
+}
+
+TEST_CASE("dirty update sends only the changed span", "[sh1106]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+  test_panel_clear_log(&s_panel);
+
+  // Nothing changed: nothing is sent
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(0, s_panel.log_len);
+
+  memset(&s_handle.buffer[2][10], 0x5A, 5);
+  sh1106_mark_dirty(&s_handle, 10, 2, 5, 1);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+
+  TEST_ASSERT_EQUAL(1, s_panel.page_calls);
+  size_t at = test_panel_expect_page_write(&s_panel, 0, 2, 10, 1,
+                                           &s_handle.buffer[2][10], 5);
+  TEST_ASSERT_EQUAL(at, s_panel.log_len);
+  TEST_ASSERT_EQUAL_HEX8(0x5A, s_panel.ram[2][10 + SH1106_COLUMN_OFFSET]);
+}
+
+TEST_CASE("failed dirty spans are resent by the next update", "[sh1106]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+
+  s_handle.buffer[1][0] = 0xFF;
+  sh1106_mark_dirty(&s_handle, 0, 1, 1, 1);
+  s_panel.fail = ESP_ERR_TIMEOUT;
+  TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, sh1106_update_dirty(&s_handle));
+
+  s_panel.fail = ESP_OK;
+  test_panel_clear_log(&s_panel);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  size_t at = test_panel_expect_page_write(&s_panel, 0, 1, 0, 1,
+                                           &s_handle.buffer[1][0], 1);
+  TEST_ASSERT_EQUAL(at, s_panel.log_len);
+}
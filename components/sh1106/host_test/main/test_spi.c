@@ -0,0 +1,95 @@
+#include "fake_driver.h"
+#include "sh1106.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <string.h>
+
+#if SH1106_BUS_DRIVERS
+
+#define TEST_DC_PIN 5
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+
+static void spi_init(void) {
+  static const sh1106_spi_config_t config = {
+      .host = 1,
+      .sclk_pin = 2,
+      .mosi_pin = 3,
+      .cs_pin = 4,
+      .dc_pin = TEST_DC_PIN,
+      .rst_pin = GPIO_NUM_NC,
+      .clock_hz = 8000000,
+      .bus_initialized = false,
+  };
+
+  test_panel_reset(&s_panel);
+  fake_driver_reset(TEST_DC_PIN, &s_panel);
+  memset(&s_handle, 0, sizeof(s_handle));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_init_spi(&s_handle, &config));
+  TEST_ASSERT_EQUAL(SH1106_SPI_QUEUE_SIZE, fake_spi.config.queue_size);
+}
+
+static void fill_pattern(uint8_t seed) {
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    for (uint8_t col = 0; col < SH1106_WIDTH; col++) {
+      s_handle.buffer[page][col] = (uint8_t)(page * 37 + col * 11 + seed);
+    }
+  }
+}
+
+static void expect_ram_is_buffer(void) {
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(s_handle.buffer[page],
+                                 &s_panel.ram[page][SH1106_COLUMN_OFFSET],
+                                 SH1106_WIDTH);
+  }
+}
+
+TEST_CASE("SPI transport sends init and frames with the D/C line",
+          "[sh1106][spi]") {
+  spi_init();
+  TEST_ASSERT_TRUE(s_panel.display_on);
+  TEST_ASSERT_EQUAL_HEX8(SH1106_DEFAULT_CONTRAST, s_panel.contrast);
+
+  fill_pattern(1);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+  expect_ram_is_buffer();
+
+  // Dirty spans take the address-command path on every controller
+  s_handle.buffer[3][10] ^= 0xFF;
+  sh1106_mark_dirty(&s_handle, 10, 3, 1, 1);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  expect_ram_is_buffer();
+
+  TEST_ASSERT_EQUAL(0, fake_spi.inflight);
+  TEST_ASSERT_EQUAL(0, fake_spi.overflows);
+  TEST_ASSERT_EQUAL(0, fake_spi.clobbered);
+}
+
+TEST_CASE("SPI queue failure does not reuse a slot still in flight",
+          "[sh1106][spi]") {
+  spi_init();
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+
+  // Every page dirty, so the update queues page after page without a wait
+  fill_pattern(7);
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    sh1106_mark_dirty(&s_handle, 0, page, SH1106_WIDTH, 1);
+  }
+
+  // Fail the second transfer of the first page write
+  fake_spi.fail_call = fake_spi.queue_calls + 2;
+  TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(0, fake_spi.clobbered);
+  TEST_ASSERT_EQUAL(0, fake_spi.overflows);
+  TEST_ASSERT_EQUAL(0, fake_spi.inflight);
+  TEST_ASSERT_LESS_THAN(s_handle.dirty_end[0], s_handle.dirty_start[0]);
+
+  // The failed page is retried and everything lands
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  TEST_ASSERT_EQUAL(0, fake_spi.clobbered);
+  expect_ram_is_buffer();
+}
+
+#endif // SH1106_BUS_DRIVERS
@@ -0,0 +1,143 @@
+#include "sh1106.h"
+#include "sh1106_sprite.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPRITE_FILL 0xA5
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_sprite_t s_sprite;
+static bool s_expected[SH1106_HEIGHT][SH1106_WIDTH];
+
+// Frame 0: 10x11 box at (1, 2) in the cell; frame 1: 6x5 box at (0, 0)
+static uint8_t s_data[10 * 2 + 6];
+static const sh1106_sprite_frame_t s_frames[] = {
+    {.offset = 0, .width = 10, .height = 11, .dx = 1, .dy = 2},
+    {.offset = 20, .width = 6, .height = 5, .dx = 0, .dy = 0},
+};
+static const sh1106_sprite_def_t s_defs[] = {
+    {.first_frame = 0, .frame_count = 2, .frame_ms = 100, .width = 12,
+     .height = 13},
+};
+static const sh1106_sprite_atlas_t s_atlas = {
+    .data = s_data,
+    .frames = s_frames,
+    .sprites = s_defs,
+    .sprite_count = 1,
+};
+
+static void atlas_fill(void) {
+  srand(7);
+  for (size_t i = 0; i < sizeof(s_data); i++) {
+    s_data[i] = (uint8_t)rand() | 0x01;
+  }
+  // Rows past the box height are blank, as the packer leaves them
+  for (uint8_t i = 0; i < 10; i++) {
+    s_data[10 + i] &= 0x07;
+  }
+  for (uint8_t i = 0; i < 6; i++) {
+    s_data[20 + i] &= 0x1F;
+  }
+}
+
+// Clear a screen rectangle in the expected image, clipped to the screen
+static void ref_clear(int x, int y, int w, int h) {
+  for (int sy = y; sy < y + h; sy++) {
+    for (int sx = x; sx < x + w; sx++) {
+      if (sx >= 0 && sx < SH1106_WIDTH && sy >= 0 && sy < SH1106_HEIGHT) {
+        s_expected[sy][sx] = false;
+      }
+    }
+  }
+}
+
+// What one sprite move must leave on screen, one pixel at a time
+static void ref_move(int old_x, int old_y, int old_frame, int x, int y,
+                     int frame) {
+  if (old_frame >= 0) {
+    const sh1106_sprite_frame_t *f = &s_frames[old_frame];
+    ref_clear(old_x + f->dx, old_y + f->dy, f->width, f->height);
+  }
+
+  const sh1106_sprite_frame_t *f = &s_frames[frame];
+  int bx = x + f->dx;
+  int by = y + f->dy;
+  ref_clear(bx, by, f->width, f->height);
+  for (int r = 0; r < f->height; r++) {
+    for (int c = 0; c < f->width; c++) {
+      int sx = bx + c;
+      int sy = by + r;
+      bool on = (s_data[f->offset + (r / 8) * f->width + c] >> (r % 8)) & 1;
+      if (on && sx >= 0 && sx < SH1106_WIDTH && sy >= 0 &&
+          sy < SH1106_HEIGHT) {
+        s_expected[sy][sx] = true;
+      }
+    }
+  }
+}
+
+// Buffer and glass both show the expected image
+static void expect_screen(int step) {
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_dirty(&s_handle));
+  for (uint8_t y = 0; y < SH1106_HEIGHT; y++) {
+    for (uint8_t x = 0; x < SH1106_WIDTH; x++) {
+      bool lit = (s_handle.buffer[y / 8][x] >> (y % 8)) & 1;
+      if (lit != s_expected[y][x] ||
+          test_panel_pixel(&s_panel, x, y) != s_expected[y][x]) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "step %d, pixel (%u, %u)", step, x, y);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+  }
+}
+
+TEST_CASE("sprite moves erase the previous box at negative coordinates",
+          "[sh1106][sprite]") {
+  static const struct {
+    int16_t x, y;
+    uint16_t frame;
+  } moves[] = {
+      {20, 10, 0},  {-5, -3, 0},  {-11, 4, 1},  {-4, -14, 0},
+      {120, -6, 0}, {125, 25, 1}, {-20, -20, 0}, {60, 20, 1},
+      {59, 21, 0},  {-1, -1, 1},
+  };
+
+  atlas_fill();
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  memset(s_handle.buffer, SPRITE_FILL, sizeof(s_handle.buffer));
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+  for (uint8_t y = 0; y < SH1106_HEIGHT; y++) {
+    for (uint8_t x = 0; x < SH1106_WIDTH; x++) {
+      s_expected[y][x] = (SPRITE_FILL >> (y % 8)) & 1;
+    }
+  }
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_sprite_init(&s_sprite, &s_handle,
+                                               &s_atlas, 0));
+
+  int old_x = 0, old_y = 0, old_frame = -1;
+  for (size_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+    sh1106_sprite_draw(&s_sprite, moves[i].x, moves[i].y, moves[i].frame);
+    ref_move(old_x, old_y, old_frame, moves[i].x, moves[i].y,
+             moves[i].frame);
+    expect_screen(i);
+    old_x = moves[i].x;
+    old_y = moves[i].y;
+    old_frame = moves[i].frame;
+  }
+
+  // Animating in place swaps the boxes the same way
+  TEST_ASSERT_TRUE(sh1106_sprite_tick(&s_sprite, 100));
+  ref_move(old_x, old_y, old_frame, old_x, old_y, 0);
+  expect_screen(-1);
+
+  // Hiding clears the last box and leaves the rest
+  sh1106_sprite_hide(&s_sprite);
+  ref_clear(old_x + s_frames[0].dx, old_y + s_frames[0].dy,
+            s_frames[0].width, s_frames[0].height);
+  expect_screen(-2);
+}
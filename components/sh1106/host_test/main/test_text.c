@@ -0,0 +1,164 @@
+#include "sh1106.h"
+#include "sh1106_text.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <string.h>
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+static sh1106_text_box_t s_box;
+
+static const uint8_t *glyph(char c) {
+  const sh1106_font_t *font = sh1106_get_font(FONT_8X8_DEFAULT);
+  return font->data + (uint8_t)(c - font->first_char) * font->width;
+}
+
+// The 8x8 glyph for @p c starts at column @p col of @p page
+static void expect_glyph(uint8_t page, uint8_t col, char c) {
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(glyph(c), &s_handle.buffer[page][col], 8);
+}
+
+static void expect_blank(uint8_t page, uint8_t from, uint8_t to) {
+  for (uint8_t col = from; col < to; col++) {
+    TEST_ASSERT_EQUAL_HEX8(0x00, s_handle.buffer[page][col]);
+  }
+}
+
+static void box_init(sh1106_align_t align, bool ellipsis, uint8_t x,
+                     uint8_t width, uint8_t height) {
+  sh1106_text_config_t config = SH1106_TEXT_CONFIG_DEFAULT();
+  config.align = align;
+  config.ellipsis = ellipsis;
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_init(&s_box, &s_handle, &config,
+                                                 x, 0, width, height));
+}
+
+TEST_CASE("text wraps at spaces and caches by content", "[sh1106][text]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  box_init(SH1106_ALIGN_LEFT, true, 0, 48, 32);
+
+  TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sh1106_text_box_layout(&s_box, NULL));
+  TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sh1106_text_box_draw(&s_box, NULL));
+  TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, sh1106_text_box_layout(NULL, "a"));
+
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, "ab cd efghij klm"));
+  TEST_ASSERT_EQUAL(3, s_box.line_count);
+  TEST_ASSERT_FALSE(s_box.overflow);
+  TEST_ASSERT_EQUAL(0, s_box.lines[0].start);
+  TEST_ASSERT_EQUAL(5, s_box.lines[0].len);
+  TEST_ASSERT_EQUAL(6, s_box.lines[1].start);
+  TEST_ASSERT_EQUAL(6, s_box.lines[1].len);
+  TEST_ASSERT_EQUAL(13, s_box.lines[2].start);
+  TEST_ASSERT_EQUAL(3, s_box.lines[2].len);
+  TEST_ASSERT_EQUAL(SH1106_TEXT_LINE_JUSTIFY, s_box.lines[0].flags);
+  TEST_ASSERT_EQUAL(0, s_box.lines[2].flags);
+
+  expect_glyph(0, 0, 'a');
+  expect_glyph(0, 8, 'b');
+  expect_glyph(0, 24, 'c');
+  expect_glyph(0, 32, 'd');
+  expect_blank(0, 40, 48);
+  for (uint8_t i = 0; i < 6; i++) {
+    expect_glyph(1, i * 8, "efghij"[i]);
+  }
+  expect_glyph(2, 0, 'k');
+  expect_glyph(2, 16, 'm');
+  expect_blank(2, 24, 48);
+
+  // The same text from another buffer is not redrawn
+  char copy[] = "ab cd efghij klm";
+  s_handle.buffer[0][0] = 0;
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, copy));
+  TEST_ASSERT_EQUAL_HEX8(0x00, s_handle.buffer[0][0]);
+
+  // A text of the same length but other content is
+  copy[0] = 'k';
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, copy));
+  expect_glyph(0, 0, 'k');
+}
+
+TEST_CASE("text aligns lines left, center, right and justified",
+          "[sh1106][text]") {
+  static const struct {
+    sh1106_align_t align;
+    uint8_t col;
+  } cases[] = {
+      {SH1106_ALIGN_LEFT, 8},
+      {SH1106_ALIGN_CENTER, 8 + (64 - 24) / 2},
+      {SH1106_ALIGN_RIGHT, 8 + 64 - 24},
+      // The last line of a paragraph is not stretched
+      {SH1106_ALIGN_JUSTIFY, 8},
+  };
+
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    memset(s_handle.buffer, 0, sizeof(s_handle.buffer));
+    box_init(cases[i].align, true, 8, 64, 8);
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, "abc"));
+    expect_blank(0, 0, cases[i].col);
+    expect_glyph(0, cases[i].col, 'a');
+    expect_glyph(0, cases[i].col + 8, 'b');
+    expect_glyph(0, cases[i].col + 16, 'c');
+    expect_blank(0, cases[i].col + 24, SH1106_WIDTH);
+  }
+
+  // "a b c" is 40 pixels in 61: the 21 spare go 11 and 10 to the spaces
+  memset(s_handle.buffer, 0, sizeof(s_handle.buffer));
+  box_init(SH1106_ALIGN_JUSTIFY, true, 0, 61, 16);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, "a b c defghi"));
+  TEST_ASSERT_EQUAL(2, s_box.line_count);
+  expect_glyph(0, 0, 'a');
+  expect_blank(0, 8, 27);
+  expect_glyph(0, 27, 'b');
+  expect_blank(0, 35, 53);
+  expect_glyph(0, 53, 'c');
+  for (uint8_t i = 0; i < 6; i++) {
+    expect_glyph(1, i * 8, "defghi"[i]);
+  }
+}
+
+TEST_CASE("text ends a cut last line with an ellipsis", "[sh1106][text]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  box_init(SH1106_ALIGN_LEFT, true, 0, 48, 8);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, "abcdef ghi"));
+
+  TEST_ASSERT_TRUE(s_box.overflow);
+  TEST_ASSERT_EQUAL(1, s_box.line_count);
+  TEST_ASSERT_EQUAL(3, s_box.lines[0].len);
+  TEST_ASSERT_EQUAL(48, s_box.lines[0].width);
+  TEST_ASSERT_EQUAL(SH1106_TEXT_LINE_ELLIPSIS, s_box.lines[0].flags);
+  expect_glyph(0, 0, 'a');
+  expect_glyph(0, 16, 'c');
+  expect_glyph(0, 24, '.');
+  expect_glyph(0, 32, '.');
+  expect_glyph(0, 40, '.');
+
+  // Without the ellipsis the line keeps every glyph that fits
+  memset(s_handle.buffer, 0, sizeof(s_handle.buffer));
+  box_init(SH1106_ALIGN_LEFT, false, 0, 48, 8);
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, "abcdef ghi"));
+  TEST_ASSERT_TRUE(s_box.overflow);
+  for (uint8_t i = 0; i < 6; i++) {
+    expect_glyph(0, i * 8, "abcdef"[i]);
+  }
+}
+
+TEST_CASE("text clips a glyph wider than the box", "[sh1106][text]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+
+  static const uint8_t xs[] = {10, SH1106_WIDTH - 4};
+  for (size_t i = 0; i < sizeof(xs) / sizeof(xs[0]); i++) {
+    uint8_t x = xs[i];
+    memset(s_handle.buffer, 0xA5, sizeof(s_handle.buffer));
+    box_init(SH1106_ALIGN_RIGHT, true, x, 4, 8);
+    TEST_ASSERT_EQUAL(ESP_OK, sh1106_text_box_draw(&s_box, "W"));
+
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(glyph('W'), &s_handle.buffer[0][x], 4);
+    // Nothing past the box, nor wrapped onto the next page's row
+    for (uint16_t col = x + 4; col < SH1106_WIDTH; col++) {
+      TEST_ASSERT_EQUAL_HEX8(0xA5, s_handle.buffer[0][col]);
+    }
+    TEST_ASSERT_EQUAL_HEX8(0xA5, s_handle.buffer[0][x - 1]);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, s_handle.buffer[1][0]);
+  }
+}
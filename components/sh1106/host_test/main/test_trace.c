@@ -0,0 +1,107 @@
+#include "sdkconfig.h"
+
+#if CONFIG_SH1106_TRACE
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sh1106.h"
+#include "sh1106_trace.h"
+#include "test_panel.h"
+#include "unity.h"
+#include <stdio.h>
+#include <string.h>
+
+static test_panel_t s_panel;
+static sh1106_handle_t s_handle;
+
+typedef struct {
+  char text[8192];
+  size_t len;
+} dump_buf_t;
+
+static dump_buf_t s_dump;
+
+static void dump_write(const void *data, size_t len, void *ctx) {
+  dump_buf_t *buf = (dump_buf_t *)ctx;
+  if (buf->len + len < sizeof(buf->text)) {
+    memcpy(buf->text + buf->len, data, len);
+    buf->len += len;
+    buf->text[buf->len] = '\0';
+  }
+}
+
+static void dump(sh1106_trace_format_t format) {
+  s_dump.len = 0;
+  s_dump.text[0] = '\0';
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_trace_dump(format, dump_write, &s_dump));
+}
+
+static unsigned count_of(const char *needle) {
+  unsigned n = 0;
+  for (const char *p = s_dump.text; (p = strstr(p, needle)) != NULL; p++) {
+    n++;
+  }
+  return n;
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+TEST_CASE("trace brackets a flush and its pages per task", "[sh1106][trace]") {
+  TEST_ASSERT_EQUAL(ESP_OK, test_panel_init(&s_panel, &s_handle));
+  sh1106_trace_reset();
+  TEST_ASSERT_EQUAL(ESP_OK, sh1106_update_display(&s_handle));
+  dump(SH1106_TRACE_FORMAT_JSON);
+
+  unsigned pages = SH1106_CONTROLLER_SSD1306 ? 1 : SH1106_PAGES;
+  TEST_ASSERT_EQUAL(1, count_of("\"name\":\"update_display\",\"ph\":\"B\""));
+  TEST_ASSERT_EQUAL(1, count_of("\"name\":\"update_display\",\"ph\":\"E\""));
+  TEST_ASSERT_EQUAL(pages, count_of("\"name\":\"page\",\"ph\":\"B\""));
+  TEST_ASSERT_EQUAL(pages, count_of("\"name\":\"page\",\"ph\":\"E\""));
+
+  // Every event is on this task's thread
+  unsigned long task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+  char with_args[32], without_args[32];
+  snprintf(with_args, sizeof(with_args), "\"tid\":%lu,", task);
+  snprintf(without_args, sizeof(without_args), "\"tid\":%lu}", task);
+  TEST_ASSERT_EQUAL(2 + 2 * pages,
+                    count_of(with_args) + count_of(without_args));
+  TEST_ASSERT_EQUAL(2 + 2 * pages, count_of("\"tid\":"));
+}
+
+TEST_CASE("trace binary stream has a header and 12-byte records",
+          "[sh1106][trace]") {
+  sh1106_trace_reset();
+  sh1106_trace_record_at(SH1106_TRACE_USER, 7, 0x1234, 0xA0B0C0D0);
+  dump(SH1106_TRACE_FORMAT_BINARY);
+
+  const uint8_t *p = (const uint8_t *)s_dump.text;
+  TEST_ASSERT_EQUAL(16 + 12, s_dump.len);
+  TEST_ASSERT_EQUAL_MEMORY(SH1106_TRACE_MAGIC, p, 4);
+  TEST_ASSERT_EQUAL(SH1106_TRACE_VERSION, p[4]);
+  TEST_ASSERT_EQUAL(12, p[5]);
+  TEST_ASSERT_EQUAL(1, read_u32(p + 8));
+
+  p += 16;
+  TEST_ASSERT_EQUAL_HEX32(0xA0B0C0D0, read_u32(p));
+  TEST_ASSERT_EQUAL(SH1106_TRACE_USER, p[4]);
+  TEST_ASSERT_EQUAL(7, p[5]);
+  TEST_ASSERT_EQUAL_HEX16(0x1234, p[6] | (p[7] << 8));
+  TEST_ASSERT_EQUAL_HEX32((uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle(),
+                          read_u32(p + 8));
+}
+
+TEST_CASE("trace unwraps rollover but not late events", "[sh1106][trace]") {
+  sh1106_trace_reset();
+  sh1106_trace_record_at(SH1106_TRACE_USER, 0, 0, 0xFFFFFF00);
+  sh1106_trace_record_at(SH1106_TRACE_USER, 1, 0, 0x100); // Rolled over
+  sh1106_trace_record_at(SH1106_TRACE_USER, 2, 0, 0xFFFFFFF0); // Late
+  dump(SH1106_TRACE_FORMAT_JSON);
+
+  TEST_ASSERT_EQUAL(1, count_of("\"ts\":4294967040,"));
+  TEST_ASSERT_EQUAL(1, count_of("\"ts\":4294967552,"));
+  TEST_ASSERT_EQUAL(1, count_of("\"ts\":4294967280,"));
+}
+
+#endif // CONFIG_SH1106_TRACE
@@ -1,26 +1,95 @@
 #ifndef SH1106_H
 #define SH1106_H
 
-#include "driver/i2c.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
 #include "sh1106_fonts.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
-// SH1106 Configuration
+// The I2C and SPI transports need the ESP-IDF bus drivers. The Linux (host)
+// target has none, so there only sh1106_init_transport() is available,
+// unless the build defines SH1106_BUS_DRIVERS=1 and supplies fakes.
+#ifndef SH1106_BUS_DRIVERS
+#if CONFIG_IDF_TARGET_LINUX
+#define SH1106_BUS_DRIVERS 0
+#else
+#define SH1106_BUS_DRIVERS 1
+#endif
+#endif
+
+#if SH1106_BUS_DRIVERS
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "driver/spi_master.h"
+#endif
+
+// Panel controller and geometry (Kconfig). Without sdkconfig the driver
+// targets an SH1106 128x64.
+#if CONFIG_SH1106_PANEL_SSD1306_128X64 || CONFIG_SH1106_PANEL_SSD1306_128X32
+#define SH1106_CONTROLLER_SSD1306 1
+#else
+#define SH1106_CONTROLLER_SSD1306 0
+#endif
+
+#if CONFIG_SH1106_PANEL_SH1106_132X64
+#define SH1106_WIDTH 132
+#else
 #define SH1106_WIDTH 128
+#endif
+
+#if CONFIG_SH1106_PANEL_SSD1306_128X32
+#define SH1106_HEIGHT 32
+#else
 #define SH1106_HEIGHT 64
-#define SH1106_PAGES 8
+#endif
+#define SH1106_PAGES (SH1106_HEIGHT / 8)
+
+// Contrast set by the init sequence; 128x32 glass is driven lower
+#if SH1106_HEIGHT == 32
+#define SH1106_DEFAULT_CONTRAST 0x8F
+#else
+#define SH1106_DEFAULT_CONTRAST 0xCF
+#endif
+
+// Display RAM width, and the RAM column shown in visible column 0. The
+// SH1106 has 132 columns of RAM and 128-column glass is centered on them.
+#if SH1106_CONTROLLER_SSD1306
+#define SH1106_RAM_COLUMNS 128
+#define SH1106_COLUMN_OFFSET 0
+#else
+#define SH1106_RAM_COLUMNS 132
+#define SH1106_COLUMN_OFFSET ((SH1106_RAM_COLUMNS - SH1106_WIDTH) / 2)
+#endif
+
+// Strip render mode: pages rendered per callback (Kconfig)
+#ifndef CONFIG_SH1106_STRIP_PAGES
+#define CONFIG_SH1106_STRIP_PAGES 1
+#endif
+#define SH1106_STRIP_PAGES CONFIG_SH1106_STRIP_PAGES
 
 // I2C Configuration
 #define SH1106_I2C_ADDRESS 0x3C
 #define SH1106_I2C_TIMEOUT_MS 1000
 
+// SPI Configuration. A page write is its address commands in 4-byte
+// descriptors, then the data; two page writes fit in flight.
+#if SH1106_CONTROLLER_SSD1306
+#define SH1106_SPI_TRANS_PER_PAGE 3 // 6 address bytes
+#else
+#define SH1106_SPI_TRANS_PER_PAGE 2 // 3 address bytes
+#endif
+#define SH1106_SPI_QUEUE_SIZE (2 * SH1106_SPI_TRANS_PER_PAGE)
+
 // Command definitions
 #define SH1106_CMD_DISPLAY_OFF 0xAE
 #define SH1106_CMD_DISPLAY_ON 0xAF
 #define SH1106_CMD_SET_CONTRAST 0x81
 #define SH1106_CMD_SET_SEGMENT_REMAP 0xA1
+#define SH1106_CMD_SET_SEGMENT_NORMAL 0xA0
 #define SH1106_CMD_SET_SCAN_DIRECTION 0xC8
+#define SH1106_CMD_SET_SCAN_NORMAL 0xC0
 #define SH1106_CMD_SET_MULTIPLEX 0xA8
 #define SH1106_CMD_SET_DISPLAY_OFFSET 0xD3
 #define SH1106_CMD_SET_CLOCK_DIV 0xD5
@@ -31,6 +100,17 @@
 #define SH1106_CMD_SET_LOW_COLUMN 0x00
 #define SH1106_CMD_SET_HIGH_COLUMN 0x10
 #define SH1106_CMD_SET_PAGE_ADDR 0xB0
+#define SH1106_CMD_SET_START_LINE 0x40 // OR with the line (0-63)
+#define SH1106_CMD_ENTIRE_DISPLAY_RAM 0xA4
+#define SH1106_CMD_ENTIRE_DISPLAY_ON 0xA5
+#define SH1106_CMD_NORMAL_DISPLAY 0xA6
+#define SH1106_CMD_INVERSE_DISPLAY 0xA7
+
+// SSD1306 only: horizontal addressing streams data across a column and page
+// window, so a full frame is one transfer
+#define SH1106_CMD_SET_MEMORY_MODE 0x20 // 0x00 = horizontal addressing
+#define SH1106_CMD_SET_COLUMN_RANGE 0x21
+#define SH1106_CMD_SET_PAGE_RANGE 0x22
 
 // Display sections
 typedef enum {
@@ -40,14 +120,115 @@ typedef enum {
   SECTION_FOOTER = 6 // Pages 6-7 (16 pixels height)
 } sh1106_section_t;
 
+// Display orientation. 0 and 180 degrees are hardware flips of the panel;
+// 90 and 270 give a portrait canvas (64x128 on a 128x64 panel) that is
+// converted to the panel layout with 8x8 bit-matrix transposes at flush
+// time. Portrait needs a width that is a multiple of 8.
+typedef enum {
+  SH1106_ROTATION_0 = 0,
+  SH1106_ROTATION_90,
+  SH1106_ROTATION_180,
+  SH1106_ROTATION_270,
+} sh1106_rotation_t;
+
+// Bus transport. The driver reaches the panel only through these hooks, so
+// a stub transport can capture the exact byte and D/C sequence on the host.
+typedef struct {
+  // Send command bytes (D/C low)
+  esp_err_t (*write_cmds)(void *ctx, const uint8_t *cmds, size_t len);
+  // Send address commands followed by pixel data (D/C high). May return
+  // before the transfer completes; data must stay valid until wait().
+  esp_err_t (*write_page)(void *ctx, const uint8_t *cmds, size_t cmd_len,
+                          const uint8_t *data, size_t len);
+  // Block until queued transfers are done (NULL for synchronous buses)
+  esp_err_t (*wait)(void *ctx);
+} sh1106_transport_t;
+
+#if SH1106_BUS_DRIVERS
+// SPI wiring (4-wire: SCLK, MOSI, CS, D/C, optional RST)
+typedef struct {
+  spi_host_device_t host;
+  gpio_num_t sclk_pin;
+  gpio_num_t mosi_pin;
+  gpio_num_t cs_pin;
+  gpio_num_t dc_pin;
+  gpio_num_t rst_pin;   // GPIO_NUM_NC if not connected
+  int clock_hz;         // SH1106 is rated for up to 10 MHz
+  bool bus_initialized; // true if the host bus is already set up and shared
+} sh1106_spi_config_t;
+
+// I2C clock tuning (see sh1106_i2c_autotune())
+typedef struct {
+  uint32_t min_hz;          // Lowest clock tried, and the runtime floor
+  uint32_t max_hz;          // Highest clock tried
+  uint32_t step_hz;         // Clock step, up while tuning and down at runtime
+  uint8_t margin_steps;     // Steps to back off from the fastest passing clock
+  uint8_t verify_rounds;    // Write/read-back rounds per step
+  uint16_t error_threshold; // Failed transfers per window that drop a step
+  uint16_t error_window;    // Transfers per error-counting window
+} sh1106_i2c_tune_config_t;
+
+#define SH1106_I2C_TUNE_CONFIG_DEFAULT()                                       \
+  {                                                                            \
+    .min_hz = 100000, .max_hz = 1000000, .step_hz = 100000,                    \
+    .margin_steps = 1, .verify_rounds = 16, .error_threshold = 4,              \
+    .error_window = 256,                                                       \
+  }
+
+// One queued SPI transfer. The descriptor comes first so the transfer
+// callbacks can get from it to the slot.
+typedef struct {
+  spi_transaction_t trans;
+#if CONFIG_SH1106_TRACE
+  uint8_t page;      // Page of a pixel transfer, 0xFF for commands
+  uint32_t begin_us; // When the transfer ran on the bus
+  uint32_t end_us;
+#endif
+} sh1106_spi_slot_t;
+#endif // SH1106_BUS_DRIVERS
+
 // SH1106 Handle
 typedef struct {
+#if SH1106_BUS_DRIVERS
   i2c_port_t i2c_port;
   uint8_t i2c_address;
-  uint8_t buffer[SH1106_PAGES][SH1106_WIDTH];
+  // I2C clock state
+  gpio_num_t i2c_sda_pin;
+  gpio_num_t i2c_scl_pin;
+  uint32_t i2c_clk_hz;
+  sh1106_i2c_tune_config_t i2c_tune;
+  bool i2c_fallback; // Step the clock down when errors climb
+  uint16_t i2c_window_xfers;
+  uint16_t i2c_window_errors;
+  uint32_t i2c_errors; // Failed I2C transfers since init
+  // SPI transport state
+  spi_device_handle_t spi_dev;
+  gpio_num_t spi_dc_pin;
+  sh1106_spi_slot_t spi_slot[SH1106_SPI_QUEUE_SIZE];
+  uint8_t spi_slot_next;
+  uint8_t spi_inflight;
+#endif
+  uint32_t frame_us; // Duration of the last full-frame update
+  const sh1106_transport_t *transport;
+  void *transport_ctx;
   const sh1106_font_t *current_font; // Current font selection
+  sh1106_rotation_t rotation;
+  uint8_t width;  // Logical width in pixels (64 in portrait)
+  uint8_t height; // Logical height in pixels (128 in portrait)
+#if CONFIG_SH1106_FRAMEBUFFER
+  // Page-major pixels. In portrait the same bytes hold a 16-page by 64-column
+  // logical canvas; see sh1106_set_rotation().
+  uint8_t buffer[SH1106_PAGES][SH1106_WIDTH];
+  // Dirty column span per page, [start, end). start >= end means clean.
+  uint8_t dirty_start[SH1106_PAGES];
+  uint8_t dirty_end[SH1106_PAGES];
+#else
+  // Double-buffered strips for sh1106_render_strips()
+  uint8_t strip_buf[2][SH1106_STRIP_PAGES][SH1106_WIDTH];
+#endif
 } sh1106_handle_t;
 
+#if SH1106_BUS_DRIVERS
 /**
  * @brief Initialize SH1106 display
  *
@@ -62,6 +243,34 @@ esp_err_t sh1106_init(sh1106_handle_t *handle, i2c_port_t i2c_port,
                       gpio_num_t sda_pin, gpio_num_t scl_pin,
                       uint32_t i2c_freq);
 
+/**
+ * @brief Initialize SH1106 display on a 4-wire SPI bus
+ *
+ * Each page goes out as one queued DMA transaction; the drawing and update
+ * API is the same as for I2C.
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param config SPI wiring and clock
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_init_spi(sh1106_handle_t *handle,
+                          const sh1106_spi_config_t *config);
+#endif // SH1106_BUS_DRIVERS
+
+/**
+ * @brief Initialize SH1106 display on a caller-provided transport
+ *
+ * Used for buses the driver does not know about and for host-side stubs.
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param transport Transport hooks (must outlive the handle)
+ * @param ctx Context passed to every hook
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_init_transport(sh1106_handle_t *handle,
+                                const sh1106_transport_t *transport,
+                                void *ctx);
+
 /**
  * @brief Clear entire display
  *
@@ -70,6 +279,7 @@ esp_err_t sh1106_init(sh1106_handle_t *handle, i2c_port_t i2c_port,
  */
 esp_err_t sh1106_clear_display(sh1106_handle_t *handle);
 
+#if CONFIG_SH1106_FRAMEBUFFER
 /**
  * @brief Clear specific section of display
  *
@@ -116,6 +326,32 @@ esp_err_t sh1106_write_text(sh1106_handle_t *handle, sh1106_section_t section,
  */
 esp_err_t sh1106_update_display(sh1106_handle_t *handle);
 
+/**
+ * @brief Send only the dirty column spans of each page
+ *
+ * @param handle Pointer to SH1106 handle
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_update_dirty(sh1106_handle_t *handle);
+
+/**
+ * @brief Mark a block of the buffer as changed
+ *
+ * Drawing functions in this driver mark what they touch; call this after
+ * writing handle->buffer directly. Coordinates are logical, so in portrait
+ * x is 0-63 and page is 0-15.
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param x First column
+ * @param page First page
+ * @param width Number of columns
+ * @param pages Number of pages
+ */
+void sh1106_mark_dirty(sh1106_handle_t *handle, uint8_t x, uint8_t page,
+                       uint8_t width, uint8_t pages);
+
+#endif // CONFIG_SH1106_FRAMEBUFFER
+
 /**
  * @brief Set contrast level
  *
@@ -125,6 +361,62 @@ esp_err_t sh1106_update_display(sh1106_handle_t *handle);
  */
 esp_err_t sh1106_set_contrast(sh1106_handle_t *handle, uint8_t contrast);
 
+#if SH1106_BUS_DRIVERS
+/**
+ * @brief Find the fastest reliable I2C clock and keep it reliable
+ *
+ * Steps the bus clock from min_hz to max_hz. At each step a pattern is
+ * written to the hidden RAM columns 130-131 and read back. Panels whose
+ * read path is not wired are verified by ACKs alone. The clock settles
+ * margin_steps below the fastest passing step. Afterwards the I2C
+ * transport drops one step whenever error_threshold transfers fail within
+ * error_window transfers, down to min_hz.
+ *
+ * Call after sh1106_init(). Ends by timing one full frame; without
+ * CONFIG_SH1106_FRAMEBUFFER that frame is blank.
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param config Tuning limits (NULL for SH1106_I2C_TUNE_CONFIG_DEFAULT)
+ * @return esp_err_t ESP_OK on success, ESP_FAIL if even min_hz fails
+ */
+esp_err_t sh1106_i2c_autotune(sh1106_handle_t *handle,
+                              const sh1106_i2c_tune_config_t *config);
+
+/**
+ * @brief Get the current I2C clock
+ *
+ * @param handle Pointer to SH1106 handle
+ * @return uint32_t Clock in Hz (0 on non-I2C transports)
+ */
+uint32_t sh1106_get_i2c_clock(const sh1106_handle_t *handle);
+#endif // SH1106_BUS_DRIVERS
+
+/**
+ * @brief Get the duration of the last full-frame update
+ *
+ * @param handle Pointer to SH1106 handle
+ * @return uint32_t Microseconds spent in the last sh1106_update_display()
+ *         or sh1106_render_strips()
+ */
+uint32_t sh1106_get_frame_time_us(const sh1106_handle_t *handle);
+
+/**
+ * @brief Set display orientation
+ *
+ * 0 and 180 degrees only flip the panel's segment and COM scan direction.
+ * 90 and 270 switch the framebuffer to a 64x128 logical canvas (16 pages of
+ * 64 columns, same page-major bit order) that the text and update functions
+ * draw into; 270 is 90 plus the hardware flip. The framebuffer is cleared
+ * because its layout changes. Portrait needs CONFIG_SH1106_FRAMEBUFFER; the
+ * strip, image and animation paths write the native layout and refuse it.
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param rotation Orientation
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_set_rotation(sh1106_handle_t *handle,
+                              sh1106_rotation_t rotation);
+
 /**
  * @brief Set font for text rendering
  *
@@ -135,6 +427,7 @@ esp_err_t sh1106_set_contrast(sh1106_handle_t *handle, uint8_t contrast);
 esp_err_t sh1106_set_font(sh1106_handle_t *handle,
                           sh1106_font_type_t font_type);
 
+#if CONFIG_SH1106_FRAMEBUFFER
 /**
  * @brief Write text with specific font
  *
@@ -178,5 +471,6 @@ esp_err_t sh1106_write_text_centered_font(sh1106_handle_t *handle,
                                           sh1106_section_t section,
                                           const char *text, uint8_t y,
                                           sh1106_font_type_t font_type);
+#endif // CONFIG_SH1106_FRAMEBUFFER
 
 #endif // SH1106_H
\ No newline at end of file
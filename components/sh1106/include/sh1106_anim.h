@@ -0,0 +1,143 @@
+#ifndef SH1106_ANIM_H
+#define SH1106_ANIM_H
+
+#include "esp_partition.h"
+#include "sdkconfig.h"
+#include "sh1106.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Animation container (all fields little-endian), produced by
+// tools/sh1106_anim_encode.py:
+//
+//   Header (16 bytes)
+//     0  char[4] magic "SHAN"
+//     4  u8      version (SH1106_ANIM_VERSION)
+//     5  u8      width in columns
+//     6  u8      pages
+//     7  u8      flags (SH1106_ANIM_FLAG_*)
+//     8  u16     frame count
+//     10 u16     frames per second
+//     12 u32     reserved
+//   Frame offset table: frame count x u32, from the start of the file
+//   Frame record
+//     u8  type (SH1106_ANIM_FRAME_*)
+//     KEY:   width * pages bytes, page-major like handle->buffer
+//     DELTA: u16 span count, then per span
+//            u8 page, u8 x, u8 len, len bytes XORed into the buffer
+#define SH1106_ANIM_MAGIC "SHAN"
+#define SH1106_ANIM_VERSION 1
+#define SH1106_ANIM_HEADER_SIZE 16
+
+#define SH1106_ANIM_FLAG_LOOP 0x01
+
+#define SH1106_ANIM_FRAME_KEY 0
+#define SH1106_ANIM_FRAME_DELTA 1
+
+// Playback statistics
+typedef struct {
+  uint32_t frames_decoded; // Frames applied to the buffer
+  uint32_t frames_shown;   // Frames flushed to the panel
+  uint32_t frames_dropped; // Frames decoded but not flushed (running late)
+  uint32_t bytes_sent;     // Pixel bytes flushed
+  uint32_t max_late_us;    // Worst lateness against the frame deadline
+} sh1106_anim_stats_t;
+
+// Animation player
+typedef struct {
+  const uint8_t *data; // Mapped animation file
+  size_t size;
+  uint16_t frame_count;
+  uint16_t fps;
+  uint8_t flags;
+  uint16_t next_frame; // Next frame to decode
+  esp_partition_mmap_handle_t mmap_handle;
+  bool partition_mapped;
+  bool file_mapped;
+  sh1106_anim_stats_t stats;
+} sh1106_anim_t;
+
+/**
+ * @brief Open an animation already in addressable memory
+ *
+ * @param anim Pointer to player state
+ * @param data Animation file contents (must stay valid while playing)
+ * @param size Size in bytes
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_anim_open_memory(sh1106_anim_t *anim, const void *data,
+                                  size_t size);
+
+/**
+ * @brief Map an animation from a data partition without copying it
+ *
+ * @param anim Pointer to player state
+ * @param label Partition label
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_anim_open_partition(sh1106_anim_t *anim, const char *label);
+
+#if CONFIG_IDF_TARGET_LINUX
+/**
+ * @brief Map an animation from a file (Linux target)
+ *
+ * @param anim Pointer to player state
+ * @param path File path
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_anim_open_file(sh1106_anim_t *anim, const char *path);
+#endif
+
+/**
+ * @brief Release the animation mapping
+ *
+ * @param anim Pointer to player state
+ */
+void sh1106_anim_close(sh1106_anim_t *anim);
+
+/**
+ * @brief Restart playback at the first frame
+ *
+ * @param anim Pointer to player state
+ */
+void sh1106_anim_rewind(sh1106_anim_t *anim);
+
+/**
+ * @brief Decode the next frame into the display buffer
+ *
+ * Only the changed spans are written and marked dirty; nothing is sent.
+ *
+ * @param anim Pointer to player state
+ * @param handle Pointer to SH1106 handle
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_FOUND at the end
+ */
+esp_err_t sh1106_anim_decode_next(sh1106_anim_t *anim,
+                                  sh1106_handle_t *handle);
+
+/**
+ * @brief Play the animation paced at its frame rate
+ *
+ * When decoding and flushing fall more than a frame behind, frames are
+ * still decoded but their flush is skipped and counted as dropped; the
+ * dirty spans carry over to the next flushed frame.
+ *
+ * @param anim Pointer to player state
+ * @param handle Pointer to SH1106 handle
+ * @param loops Number of passes; 0 plays once, or forever if the file
+ * has SH1106_ANIM_FLAG_LOOP set
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_anim_play(sh1106_anim_t *anim, sh1106_handle_t *handle,
+                           uint32_t loops);
+
+/**
+ * @brief Get playback statistics
+ *
+ * @param anim Pointer to player state
+ * @param stats Output statistics
+ */
+void sh1106_anim_get_stats(const sh1106_anim_t *anim,
+                           sh1106_anim_stats_t *stats);
+
+#endif // SH1106_ANIM_H
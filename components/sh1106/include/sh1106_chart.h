@@ -0,0 +1,116 @@
+#ifndef SH1106_CHART_H
+#define SH1106_CHART_H
+
+#include "sh1106.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// One column per sample, plus the sample just left of the chart so the
+// first line segment can be drawn the same way after a full redraw
+#define SH1106_CHART_CAPACITY (SH1106_WIDTH + 1)
+
+typedef enum {
+  SH1106_CHART_LINE = 0, // Sparkline joining consecutive samples
+  SH1106_CHART_BARS,     // Bar from the bottom up to each sample
+  SH1106_CHART_BAND,     // Span between each sample's min and max
+} sh1106_chart_style_t;
+
+typedef struct {
+  int16_t min;
+  int16_t max; // Same as min for single values
+} sh1106_chart_sample_t;
+
+// Scrolling chart on whole pages. The newest sample is in the rightmost
+// column; adding one shifts the drawn columns left and draws only the new
+// column, unless the scale changes.
+typedef struct {
+  sh1106_handle_t *display;
+  sh1106_chart_style_t style;
+  uint8_t x;         // Left edge
+  uint8_t width;     // Width in columns (one sample each)
+  uint8_t page;      // Top page
+  uint8_t pages;     // Height in pages
+  bool autoscale;    // Fit the range to the visible samples
+  int16_t range_min; // Value drawn on the bottom row
+  int16_t range_max; // Value drawn on the top row
+  uint8_t head;      // Next slot in samples
+  uint8_t count;     // Stored samples (at most width + 1)
+  sh1106_chart_sample_t samples[SH1106_CHART_CAPACITY];
+} sh1106_chart_t;
+
+/**
+ * @brief Initialize an empty, autoscaling chart and clear its area
+ *
+ * @param chart Pointer to chart
+ * @param handle Pointer to SH1106 handle
+ * @param style Drawing style
+ * @param x Left edge (column)
+ * @param page Top page
+ * @param width Width in columns (clipped to the display)
+ * @param pages Height in pages (clipped to the display)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_chart_init(sh1106_chart_t *chart, sh1106_handle_t *handle,
+                            sh1106_chart_style_t style, uint8_t x,
+                            uint8_t page, uint8_t width, uint8_t pages);
+
+/**
+ * @brief Use a fixed value range (disables autoscaling) and redraw
+ *
+ * Samples outside the range are clipped to the top or bottom row.
+ *
+ * @param chart Pointer to chart
+ * @param min Value of the bottom row
+ * @param max Value of the top row (greater than min)
+ */
+void sh1106_chart_set_range(sh1106_chart_t *chart, int16_t min, int16_t max);
+
+/**
+ * @brief Enable or disable autoscaling
+ *
+ * The range follows the visible samples. It grows as soon as a sample
+ * leaves it and shrinks once the samples span less than half of it, so
+ * noisy data does not force a full redraw on every sample.
+ *
+ * @param chart Pointer to chart
+ * @param enable true to autoscale
+ */
+void sh1106_chart_set_autoscale(sh1106_chart_t *chart, bool enable);
+
+/**
+ * @brief Add a sample
+ *
+ * Shifts the chart one column left and draws the new column, or redraws
+ * the whole chart if the autoscale range changed.
+ *
+ * @param chart Pointer to chart
+ * @param value Sample value
+ */
+void sh1106_chart_add(sh1106_chart_t *chart, int16_t value);
+
+/**
+ * @brief Add a sample with a min/max spread (for SH1106_CHART_BAND)
+ *
+ * Line and bar charts draw the max.
+ *
+ * @param chart Pointer to chart
+ * @param min Lowest value in the sample period
+ * @param max Highest value in the sample period
+ */
+void sh1106_chart_add_range(sh1106_chart_t *chart, int16_t min, int16_t max);
+
+/**
+ * @brief Drop all samples and clear the chart area
+ *
+ * @param chart Pointer to chart
+ */
+void sh1106_chart_clear(sh1106_chart_t *chart);
+
+/**
+ * @brief Redraw every column from the stored samples
+ *
+ * @param chart Pointer to chart
+ */
+void sh1106_chart_redraw(sh1106_chart_t *chart);
+
+#endif // SH1106_CHART_H
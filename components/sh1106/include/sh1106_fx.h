@@ -0,0 +1,91 @@
+#ifndef SH1106_FX_H
+#define SH1106_FX_H
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sh1106.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Transition effects. Fades and blinks cost 1-3 command bytes per step;
+// slides and wipes one page plus a start-line command per step.
+typedef enum {
+  SH1106_FX_FADE_IN = 0,  // Display on, contrast 0 up to the target
+  SH1106_FX_FADE_OUT,     // Contrast down to 0, then display off
+  SH1106_FX_BLINK,        // Toggle inverse display (0xA7/0xA6)
+  SH1106_FX_FLASH,        // Toggle entire display on (0xA5/0xA4)
+  SH1106_FX_SLIDE_UP,     // Current frame moves up, target enters below
+  SH1106_FX_SLIDE_DOWN,   // Current frame moves down, target enters above
+  SH1106_FX_WIPE_DOWN,    // Target replaces the current frame from the top
+} sh1106_fx_type_t;
+
+// Transition configuration
+typedef struct {
+  sh1106_fx_type_t type;
+  uint32_t duration_ms;      // Total duration
+  uint16_t steps;            // Timer steps (0 = 16 for fades, 32 for slides)
+  uint8_t contrast;          // Fade target, restored after a fade-out
+  uint8_t count;             // Blink/flash cycles
+  const uint8_t (*to)[SH1106_WIDTH]; // Target frame for slides and wipes
+  UBaseType_t task_priority; // Priority of the step task
+} sh1106_fx_config_t;
+
+#define SH1106_FX_CONFIG_DEFAULT()                                             \
+  {                                                                            \
+    .type = SH1106_FX_FADE_IN, .duration_ms = 500, .steps = 0,                 \
+    .contrast = SH1106_DEFAULT_CONTRAST, .count = 3, .to = NULL,               \
+    .task_priority = configMAX_PRIORITIES - 3,                                 \
+  }
+
+// Transition state
+typedef struct {
+  sh1106_handle_t *display;
+  sh1106_fx_config_t config;
+  esp_timer_handle_t timer;
+  TaskHandle_t task;
+  SemaphoreHandle_t done;
+  volatile bool running; // Steps left to apply
+  volatile bool cancel;
+  uint16_t step;   // Steps done
+  uint16_t total;  // Steps in the effect
+  uint8_t line;    // Rows of the target shown (slides and wipes)
+  esp_err_t error; // First bus error, if any
+  uint8_t page_buf[SH1106_WIDTH];
+} sh1106_fx_t;
+
+/**
+ * @brief Start a transition
+ *
+ * Steps run from a timer-driven task; do not draw to or flush the display
+ * until sh1106_fx_wait() returns. Slides and wipes start from the content
+ * of handle->buffer (assumed on screen) and leave config->to copied into
+ * it. They need a landscape rotation (0 or 180 degrees).
+ *
+ * @param fx Pointer to transition state
+ * @param handle Pointer to SH1106 handle
+ * @param config Effect to run
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_fx_start(sh1106_fx_t *fx, sh1106_handle_t *handle,
+                          const sh1106_fx_config_t *config);
+
+/**
+ * @brief Wait for a transition to finish and release its resources
+ *
+ * @param fx Pointer to transition state
+ * @param timeout Ticks to wait
+ * @return esp_err_t ESP_OK, ESP_ERR_TIMEOUT, or the first bus error
+ */
+esp_err_t sh1106_fx_wait(sh1106_fx_t *fx, TickType_t timeout);
+
+/**
+ * @brief Jump to the final state of a running transition and wait for it
+ *
+ * @param fx Pointer to transition state
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_fx_finish(sh1106_fx_t *fx);
+
+#endif // SH1106_FX_H
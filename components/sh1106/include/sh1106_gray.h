@@ -0,0 +1,165 @@
+#ifndef SH1106_GRAY_H
+#define SH1106_GRAY_H
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sh1106.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Grayscale levels (2 bits per pixel)
+#define SH1106_GRAY_LEVELS 4
+
+// Bitplane weighting strategy
+typedef enum {
+  // MSB plane shown for 2 subframes, LSB plane for 1 (3 subframes per frame)
+  SH1106_GRAY_MODE_PWM = 0,
+  // MSB plane at high contrast, LSB plane at low contrast (2 subframes)
+  SH1106_GRAY_MODE_CONTRAST
+} sh1106_gray_mode_t;
+
+// Grayscale engine configuration
+typedef struct {
+  uint16_t subframe_hz;      // Bitplane flip rate
+  sh1106_gray_mode_t mode;   // Bitplane weighting strategy
+  uint8_t contrast_high;     // Contrast for the MSB plane (and PWM mode)
+  uint8_t contrast_low;      // Contrast for the LSB plane in contrast mode
+  UBaseType_t task_priority; // Priority of the flush task
+  BaseType_t core_id;        // Core to pin the flush task to
+} sh1106_gray_config_t;
+
+#define SH1106_GRAY_CONFIG_DEFAULT()                                           \
+  {                                                                            \
+    .subframe_hz = 150, .mode = SH1106_GRAY_MODE_PWM,                          \
+    .contrast_high = SH1106_DEFAULT_CONTRAST, .contrast_low = 0x60,            \
+    .task_priority = configMAX_PRIORITIES - 2,                                 \
+    .core_id = tskNO_AFFINITY,                                                 \
+  }
+
+// Frame timing statistics
+typedef struct {
+  uint32_t subframes;      // Subframes processed since start/reset
+  uint32_t flushed;        // Subframes that actually went over the bus
+  uint32_t late_subframes; // Timer ticks missed because a flush overran
+  uint32_t min_flush_us;   // Shortest bus flush
+  uint32_t max_flush_us;   // Longest bus flush
+  uint32_t avg_flush_us;   // Mean bus flush
+  uint32_t achieved_hz;    // Measured subframe rate
+  uint16_t target_hz;      // Configured subframe rate
+} sh1106_gray_stats_t;
+
+// Grayscale engine state
+typedef struct {
+  sh1106_handle_t *display;
+  // 2bpp surface, page-major like the 1bpp buffer. Each column word holds
+  // 8 pixels: bit 2*row is the LSB, bit 2*row+1 the MSB of that row.
+  uint16_t pixels[SH1106_PAGES][SH1106_WIDTH];
+  uint8_t plane[SH1106_PAGES][SH1106_WIDTH]; // Bitplane being sent
+  sh1106_gray_config_t config;
+  esp_timer_handle_t timer;
+  TaskHandle_t task;
+  SemaphoreHandle_t done;
+  volatile bool running;        // Flush task active (cleared once parked)
+  volatile bool stopping;       // sh1106_gray_stop() asked the task to park
+  volatile uint32_t generation; // Bumped on every drawing call
+  uint32_t shown_generation;    // Generation of the plane on the panel
+  int8_t shown_plane;           // Plane on the panel (-1 = none)
+  uint8_t phase;                // Position in the subframe sequence
+  uint8_t shown_contrast;
+  // Stats accumulators
+  int64_t stats_start_us;
+  uint64_t flush_total_us;
+  sh1106_gray_stats_t stats;
+} sh1106_gray_t;
+
+/**
+ * @brief Initialize grayscale engine for a display
+ *
+ * @param gray Pointer to grayscale engine state
+ * @param display Initialized SH1106 handle
+ * @param config Engine configuration (NULL for defaults)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_gray_init(sh1106_gray_t *gray, sh1106_handle_t *display,
+                           const sh1106_gray_config_t *config);
+
+/**
+ * @brief Start the high-priority bitplane flush task
+ *
+ * While running the engine owns the bus; do not call
+ * sh1106_update_display() on the same handle until stopped. Only the 0 and
+ * 180 degree rotations are supported; do not change the rotation while
+ * running.
+ *
+ * @param gray Pointer to grayscale engine state
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_SUPPORTED in a portrait
+ * rotation
+ */
+esp_err_t sh1106_gray_start(sh1106_gray_t *gray);
+
+/**
+ * @brief Stop the flush task and restore the configured contrast
+ *
+ * @param gray Pointer to grayscale engine state
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_gray_stop(sh1106_gray_t *gray);
+
+/**
+ * @brief Clear the 2bpp surface
+ *
+ * @param gray Pointer to grayscale engine state
+ */
+void sh1106_gray_clear(sh1106_gray_t *gray);
+
+/**
+ * @brief Set a single pixel
+ *
+ * @param gray Pointer to grayscale engine state
+ * @param x X position (0-127)
+ * @param y Y position (0-63)
+ * @param level Gray level (0-3)
+ */
+void sh1106_gray_set_pixel(sh1106_gray_t *gray, uint8_t x, uint8_t y,
+                           uint8_t level);
+
+/**
+ * @brief Fill a rectangle with a gray level
+ *
+ * @param gray Pointer to grayscale engine state
+ * @param x Left edge
+ * @param y Top edge
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param level Gray level (0-3)
+ */
+void sh1106_gray_fill_rect(sh1106_gray_t *gray, uint8_t x, uint8_t y,
+                           uint8_t w, uint8_t h, uint8_t level);
+
+/**
+ * @brief Import set pixels of the display's 1bpp buffer at a gray level
+ *
+ * Lets the existing text functions draw into the grayscale surface: render
+ * into handle->buffer, then import it with the wanted level. Pixels that are
+ * clear in the 1bpp buffer keep their current gray value.
+ *
+ * @param gray Pointer to grayscale engine state
+ * @param level Gray level (0-3) for set pixels
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_SUPPORTED in a portrait
+ * rotation
+ */
+esp_err_t sh1106_gray_import_buffer(sh1106_gray_t *gray, uint8_t level);
+
+/**
+ * @brief Get frame timing statistics
+ *
+ * @param gray Pointer to grayscale engine state
+ * @param stats Output statistics
+ * @param reset Restart the measurement window after reading
+ */
+void sh1106_gray_get_stats(sh1106_gray_t *gray, sh1106_gray_stats_t *stats,
+                           bool reset);
+
+#endif // SH1106_GRAY_H
@@ -0,0 +1,94 @@
+#ifndef SH1106_IMAGE_H
+#define SH1106_IMAGE_H
+
+#include "sh1106.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Dithering methods
+typedef enum {
+  SH1106_DITHER_THRESHOLD = 0,  // Fixed threshold
+  SH1106_DITHER_BAYER,          // Ordered 8x8 Bayer matrix
+  SH1106_DITHER_FLOYD_STEINBERG // Error diffusion
+} sh1106_dither_t;
+
+// Scaling filters
+typedef enum {
+  SH1106_SCALE_NONE = 0, // 1:1, clipped to the destination
+  SH1106_SCALE_NEAREST,  // Nearest neighbour
+  SH1106_SCALE_BOX       // Box (area average) filter
+} sh1106_scale_t;
+
+// Image conversion configuration
+typedef struct {
+  uint16_t src_width;     // Source width in pixels
+  uint16_t src_height;    // Source height in pixels
+  uint8_t dst_x;          // Destination left edge on the display
+  uint8_t dst_y;          // Destination top edge on the display
+  uint8_t dst_width;      // Destination width (0 = up to the right edge)
+  uint8_t dst_height;     // Destination height (0 = up to the bottom edge)
+  sh1106_dither_t dither; // Dithering method
+  sh1106_scale_t scale;   // Scaling filter
+  uint8_t threshold;      // Pixels above this are lit (threshold mode)
+  bool invert;            // Invert source values before dithering
+} sh1106_image_config_t;
+
+// Streaming conversion state. Holds one packed page band plus one row of
+// scratch, accumulator and error terms - never the whole image.
+typedef struct {
+  sh1106_handle_t *display;
+  sh1106_image_config_t cfg;
+  uint16_t src_row;                // Source rows consumed so far
+  uint8_t dst_row;                 // Destination rows emitted so far
+  uint8_t band_mask;               // Rows of the current page present in band
+  uint8_t band[SH1106_WIDTH];      // Packed 1bpp bits of the current page
+  uint8_t row[SH1106_WIDTH];       // Horizontally resampled gray row
+  uint32_t accum[SH1106_WIDTH];    // Vertical box filter accumulator
+  uint16_t accum_rows;             // Rows summed into accum
+  int16_t err[SH1106_WIDTH];       // Floyd-Steinberg error for next row
+} sh1106_image_t;
+
+/**
+ * @brief Begin a streaming conversion into the display buffer
+ *
+ * @param img Pointer to conversion state
+ * @param handle Pointer to SH1106 handle
+ * @param config Conversion configuration
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_image_begin(sh1106_image_t *img, sh1106_handle_t *handle,
+                             const sh1106_image_config_t *config);
+
+/**
+ * @brief Push the next 8-bit grayscale source row
+ *
+ * Completed 8-row page bands are written straight into handle->buffer.
+ *
+ * @param img Pointer to conversion state
+ * @param row Source row, src_width bytes
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_image_push_row(sh1106_image_t *img, const uint8_t *row);
+
+/**
+ * @brief Finish conversion and write any partial band
+ *
+ * @param img Pointer to conversion state
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_image_end(sh1106_image_t *img);
+
+/**
+ * @brief Convert a whole grayscale image from memory
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param config Conversion configuration
+ * @param pixels Source pixels, row-major
+ * @param stride Bytes between source rows
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_image_draw(sh1106_handle_t *handle,
+                            const sh1106_image_config_t *config,
+                            const uint8_t *pixels, size_t stride);
+
+#endif // SH1106_IMAGE_H
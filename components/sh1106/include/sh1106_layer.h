@@ -0,0 +1,189 @@
+#ifndef SH1106_LAYER_H
+#define SH1106_LAYER_H
+
+#include "sh1106.h"
+#include "sh1106_fonts.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bytes needed for a layer's pixel buffer
+#define SH1106_LAYER_BUF_SIZE(width, height) ((width) * (((height) + 7) / 8))
+
+// How a layer combines with what is below it
+typedef enum {
+  SH1106_BLEND_OPAQUE = 0, // Replace everything under the layer rectangle
+  SH1106_BLEND_OR,         // Light the layer's set pixels
+  SH1106_BLEND_XOR,        // Invert under the layer's set pixels
+  SH1106_BLEND_MASK        // Clear under the layer's set pixels
+} sh1106_blend_t;
+
+// Off-screen 1bpp canvas. Pixels use the display's page-major layout:
+// bit r of pixels[page * width + x] is layer row 8 * page + r.
+typedef struct sh1106_layer {
+  uint8_t *pixels;
+  uint8_t width;
+  uint8_t height;
+  int16_t x; // Screen position of the top-left pixel, may be off-screen
+  int16_t y;
+  sh1106_blend_t blend;
+  bool visible;
+  // Changed rectangle in layer coordinates, [x0, x1) x [y0, y1)
+  uint8_t dirty_x0, dirty_y0, dirty_x1, dirty_y1;
+  // State at the last composite, to damage what moved or was toggled
+  int16_t shown_x;
+  int16_t shown_y;
+  bool shown_visible;
+  struct sh1106_layer *next; // Next layer up
+} sh1106_layer_t;
+
+// Layer stack composited into a display's framebuffer
+typedef struct {
+  sh1106_handle_t *display;
+  sh1106_layer_t *bottom;
+  // Screen damage per page, [start, end). start >= end means clean.
+  uint8_t damage_start[SH1106_PAGES];
+  uint8_t damage_end[SH1106_PAGES];
+} sh1106_compositor_t;
+
+/**
+ * @brief Initialize a compositor on a display
+ *
+ * Screen areas no visible layer covers composite to blank, so content that
+ * must survive overlays belongs in a bottom layer (typically a full-screen
+ * opaque one) rather than in handle->buffer.
+ *
+ * @param comp Pointer to compositor
+ * @param handle Pointer to SH1106 handle
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_compositor_init(sh1106_compositor_t *comp,
+                                 sh1106_handle_t *handle);
+
+/**
+ * @brief Put a layer on top of the stack
+ *
+ * @param comp Pointer to compositor
+ * @param layer Initialized layer (must stay valid while in the stack)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_compositor_add(sh1106_compositor_t *comp,
+                                sh1106_layer_t *layer);
+
+/**
+ * @brief Take a layer out of the stack and damage the area it covered
+ *
+ * @param comp Pointer to compositor
+ * @param layer Layer to remove
+ */
+void sh1106_compositor_remove(sh1106_compositor_t *comp,
+                              sh1106_layer_t *layer);
+
+/**
+ * @brief Composite damaged areas into the framebuffer
+ *
+ * Only the page spans where a layer changed, moved or was shown or hidden
+ * are rebuilt, and only those are marked dirty on the display. Follow with
+ * sh1106_update_dirty() to send them.
+ *
+ * @param comp Pointer to compositor
+ * @return esp_err_t ESP_OK on success, ESP_ERR_NOT_SUPPORTED in portrait
+ */
+esp_err_t sh1106_compositor_render(sh1106_compositor_t *comp);
+
+/**
+ * @brief Initialize a hidden, opaque layer at the screen origin
+ *
+ * @param layer Pointer to layer
+ * @param pixels Buffer of SH1106_LAYER_BUF_SIZE(width, height) bytes
+ * @param width Width in pixels (1-128)
+ * @param height Height in pixels (1-64)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_layer_init(sh1106_layer_t *layer, uint8_t *pixels,
+                            uint8_t width, uint8_t height);
+
+/**
+ * @brief Move a layer
+ *
+ * @param layer Pointer to layer
+ * @param x Screen column of the left edge
+ * @param y Screen row of the top edge
+ */
+void sh1106_layer_set_position(sh1106_layer_t *layer, int16_t x, int16_t y);
+
+/**
+ * @brief Show or hide a layer
+ *
+ * @param layer Pointer to layer
+ * @param visible Visibility
+ */
+void sh1106_layer_set_visible(sh1106_layer_t *layer, bool visible);
+
+/**
+ * @brief Change how a layer combines with the layers below
+ *
+ * @param layer Pointer to layer
+ * @param blend Blend mode
+ */
+void sh1106_layer_set_blend(sh1106_layer_t *layer, sh1106_blend_t blend);
+
+/**
+ * @brief Mark part of a layer as changed
+ *
+ * The drawing helpers below do this themselves; call it after writing
+ * layer->pixels directly.
+ *
+ * @param layer Pointer to layer
+ * @param x Left edge in layer coordinates
+ * @param y Top edge in layer coordinates
+ * @param w Width in pixels
+ * @param h Height in pixels
+ */
+void sh1106_layer_mark_dirty(sh1106_layer_t *layer, uint8_t x, uint8_t y,
+                             uint8_t w, uint8_t h);
+
+/**
+ * @brief Clear all pixels of a layer
+ *
+ * @param layer Pointer to layer
+ */
+void sh1106_layer_clear(sh1106_layer_t *layer);
+
+/**
+ * @brief Set or clear a pixel
+ *
+ * @param layer Pointer to layer
+ * @param x X position in layer coordinates
+ * @param y Y position in layer coordinates
+ * @param on Pixel state
+ */
+void sh1106_layer_set_pixel(sh1106_layer_t *layer, uint8_t x, uint8_t y,
+                            bool on);
+
+/**
+ * @brief Fill a rectangle, clipped to the layer
+ *
+ * @param layer Pointer to layer
+ * @param x Left edge
+ * @param y Top edge
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param on Pixel state
+ */
+void sh1106_layer_fill_rect(sh1106_layer_t *layer, uint8_t x, uint8_t y,
+                            uint8_t w, uint8_t h, bool on);
+
+/**
+ * @brief Draw text at any pixel row, clipped to the layer
+ *
+ * @param layer Pointer to layer
+ * @param font_type Font to use
+ * @param text Text string to display
+ * @param x X position (column)
+ * @param y Y position of the glyph top
+ */
+void sh1106_layer_draw_text(sh1106_layer_t *layer,
+                            sh1106_font_type_t font_type, const char *text,
+                            uint8_t x, uint8_t y);
+
+#endif // SH1106_LAYER_H
@@ -0,0 +1,83 @@
+#ifndef SH1106_LIST_H
+#define SH1106_LIST_H
+
+#include "sh1106.h"
+#include "sh1106_fonts.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define SH1106_LIST_TEXT_MAX 32 // Scratch size handed to get_item
+
+// Supplies list items on demand; the list never holds more than the text
+// of the row being drawn
+typedef struct {
+  // Number of items
+  uint32_t (*count)(void *ctx);
+  // Text of item @p index. May format into buf (size bytes) and return it,
+  // or return a pointer to existing storage.
+  const char *(*get_item)(uint32_t index, char *buf, size_t size, void *ctx);
+  void *ctx;
+} sh1106_list_provider_t;
+
+// Scrolling list of one-page rows with an inverted selection row
+typedef struct {
+  sh1106_handle_t *display;
+  sh1106_list_provider_t provider;
+  const sh1106_font_t *font;
+  uint8_t x;         // Left edge
+  uint8_t width;     // Width in columns
+  uint8_t page;      // First row's page
+  uint8_t rows;      // Visible rows
+  uint32_t count;    // Item count at the last refresh
+  uint32_t top;      // Item shown in the first row
+  uint32_t selected; // Selected item, always visible
+} sh1106_list_t;
+
+/**
+ * @brief Initialize a list and draw its first screen
+ *
+ * @param list Pointer to list
+ * @param handle Pointer to SH1106 handle
+ * @param provider Item provider (copied)
+ * @param font_type Font to use
+ * @param x Left edge (column)
+ * @param page First page
+ * @param width Width in columns (clipped to the display)
+ * @param rows Number of visible rows (clipped to the display)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_list_init(sh1106_list_t *list, sh1106_handle_t *handle,
+                           const sh1106_list_provider_t *provider,
+                           sh1106_font_type_t font_type, uint8_t x,
+                           uint8_t page, uint8_t width, uint8_t rows);
+
+/**
+ * @brief Re-read the item count and redraw every visible row
+ *
+ * Call when items were added, removed or changed.
+ *
+ * @param list Pointer to list
+ */
+void sh1106_list_refresh(sh1106_list_t *list);
+
+/**
+ * @brief Select an item, scrolling as little as needed to show it
+ *
+ * Moving within the visible rows only re-inverts the old and new row.
+ * Scrolling shifts the rows already drawn and asks the provider only for
+ * the rows that come into view.
+ *
+ * @param list Pointer to list
+ * @param index Item to select (clamped to the last item)
+ */
+void sh1106_list_select(sh1106_list_t *list, uint32_t index);
+
+/**
+ * @brief Move the selection by a number of items
+ *
+ * @param list Pointer to list
+ * @param delta Items to move, negative moves up (clamped to the list)
+ */
+void sh1106_list_move(sh1106_list_t *list, int32_t delta);
+
+#endif // SH1106_LIST_H
@@ -0,0 +1,77 @@
+#ifndef SH1106_NUMFIELD_H
+#define SH1106_NUMFIELD_H
+
+#include "sh1106.h"
+#include "sh1106_fonts.h"
+#include <stdint.h>
+
+#define SH1106_NUMFIELD_MAX_CELLS 12 // Enough for any int32_t with sign
+
+// Right-aligned numeric field in a fixed box of glyph cells on one page.
+// Remembers the glyphs on screen so only cells that change are redrawn.
+// A value that does not fit fills the box with '#'.
+typedef struct {
+  sh1106_handle_t *display;
+  const sh1106_font_t *font;
+  uint8_t x;     // Left edge of the box
+  uint8_t page;  // Page the glyphs are drawn on
+  uint8_t cells; // Box width in glyphs
+  char shown[SH1106_NUMFIELD_MAX_CELLS]; // On screen, '\0' = unknown
+} sh1106_numfield_t;
+
+/**
+ * @brief Initialize a numeric field
+ *
+ * Nothing is drawn until the first value is set.
+ *
+ * @param field Pointer to field
+ * @param handle Pointer to SH1106 handle
+ * @param font_type Font to use
+ * @param x Left edge of the box (column)
+ * @param page Page to draw on
+ * @param cells Box width in glyphs (1-SH1106_NUMFIELD_MAX_CELLS)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_numfield_init(sh1106_numfield_t *field,
+                               sh1106_handle_t *handle,
+                               sh1106_font_type_t font_type, uint8_t x,
+                               uint8_t page, uint8_t cells);
+
+/**
+ * @brief Show an integer
+ *
+ * @param field Pointer to field
+ * @param value Value
+ */
+void sh1106_numfield_set_int(sh1106_numfield_t *field, int32_t value);
+
+/**
+ * @brief Show a fixed-point value
+ *
+ * @param field Pointer to field
+ * @param value Value scaled by 10^decimals (234 with 1 decimal is 23.4)
+ * @param decimals Digits after the decimal point (0-9)
+ */
+void sh1106_numfield_set_fixed(sh1106_numfield_t *field, int32_t value,
+                               uint8_t decimals);
+
+/**
+ * @brief Show a float rounded to a given precision
+ *
+ * @param field Pointer to field
+ * @param value Value
+ * @param precision Digits after the decimal point (0-9)
+ */
+void sh1106_numfield_set_float(sh1106_numfield_t *field, float value,
+                               uint8_t precision);
+
+/**
+ * @brief Forget what is on screen so the next value redraws every cell
+ *
+ * Call after clearing or overdrawing the area under the field.
+ *
+ * @param field Pointer to field
+ */
+void sh1106_numfield_invalidate(sh1106_numfield_t *field);
+
+#endif // SH1106_NUMFIELD_H
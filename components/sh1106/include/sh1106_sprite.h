@@ -0,0 +1,96 @@
+#ifndef SH1106_SPRITE_H
+#define SH1106_SPRITE_H
+
+#include "sh1106.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Sprite atlas, generated by tools/sh1106_sprite_pack.py. Each frame is
+// trimmed to its inked box and stored page-major like handle->buffer: bit r
+// of byte [p * width + x] is row 8p + r of the box.
+typedef struct {
+  uint32_t offset; // Start of the frame's bytes in the atlas data
+  uint8_t width;   // Inked box width (0 for a blank frame)
+  uint8_t height;  // Inked box height; the data holds (height + 7) / 8 pages
+  uint8_t dx;      // Box position within the sprite cell
+  uint8_t dy;
+} sh1106_sprite_frame_t;
+
+typedef struct {
+  uint16_t first_frame; // Index into the frame table
+  uint16_t frame_count;
+  uint16_t frame_ms; // Time per frame when animated with sh1106_sprite_tick
+  uint8_t width;     // Cell size
+  uint8_t height;
+} sh1106_sprite_def_t;
+
+typedef struct {
+  const uint8_t *data;
+  const sh1106_sprite_frame_t *frames;
+  const sh1106_sprite_def_t *sprites;
+  uint16_t sprite_count;
+} sh1106_sprite_atlas_t;
+
+// A sprite placed on the display. Remembers the box it last drew so moving
+// or animating it erases only that box.
+typedef struct {
+  sh1106_handle_t *display;
+  const sh1106_sprite_atlas_t *atlas;
+  const sh1106_sprite_def_t *def;
+  uint16_t frame;      // Current frame, 0..frame_count-1
+  int16_t x;           // Cell position
+  int16_t y;
+  uint32_t elapsed_ms; // Time spent on the current frame
+  bool shown;
+  int16_t box_x; // Box drawn last (width 0 = nothing on screen)
+  int16_t box_y;
+  uint8_t box_w;
+  uint8_t box_h;
+} sh1106_sprite_t;
+
+/**
+ * @brief Initialize a sprite (not drawn yet)
+ *
+ * @param sprite Pointer to sprite
+ * @param handle Pointer to SH1106 handle
+ * @param atlas Atlas holding the sprite
+ * @param id Sprite index in the atlas (the generated enum)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_sprite_init(sh1106_sprite_t *sprite, sh1106_handle_t *handle,
+                             const sh1106_sprite_atlas_t *atlas, uint16_t id);
+
+/**
+ * @brief Draw a frame with the cell's top-left corner at (x, y)
+ *
+ * Erases the box drawn last, then draws the frame's inked box opaquely.
+ * Only the two boxes are marked dirty. Coordinates may be partly off
+ * screen.
+ *
+ * @param sprite Pointer to sprite
+ * @param x Cell left edge
+ * @param y Cell top row
+ * @param frame Frame to show (wraps at the frame count)
+ */
+void sh1106_sprite_draw(sh1106_sprite_t *sprite, int16_t x, int16_t y,
+                        uint16_t frame);
+
+/**
+ * @brief Advance the animation by elapsed time
+ *
+ * Redraws only if the frame changed. Does nothing while hidden.
+ *
+ * @param sprite Pointer to sprite
+ * @param elapsed_ms Time since the last tick
+ * @return true if a new frame was drawn
+ */
+bool sh1106_sprite_tick(sh1106_sprite_t *sprite, uint32_t elapsed_ms);
+
+/**
+ * @brief Erase the sprite and stop drawing it on ticks
+ *
+ * @param sprite Pointer to sprite
+ */
+void sh1106_sprite_hide(sh1106_sprite_t *sprite);
+
+#endif // SH1106_SPRITE_H
@@ -0,0 +1,82 @@
+#ifndef SH1106_STRIP_H
+#define SH1106_STRIP_H
+
+#include "sh1106.h"
+#include "sh1106_fonts.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// One horizontal band of the display handed to a draw callback
+typedef struct {
+  uint8_t (*buf)[SH1106_WIDTH]; // buf[0..pages-1][column]
+  uint8_t page;                 // First display page covered
+  uint8_t pages;                // Pages in this strip
+} sh1106_strip_t;
+
+/**
+ * @brief Draw callback for strip rendering
+ *
+ * Called once per strip, top to bottom, with a cleared strip buffer. Draw
+ * in display coordinates; anything outside the strip is clipped.
+ *
+ * @param strip Strip to draw into
+ * @param ctx User context
+ * @return esp_err_t ESP_OK to continue, anything else aborts the frame
+ */
+typedef esp_err_t (*sh1106_strip_draw_cb_t)(sh1106_strip_t *strip,
+                                            void *ctx);
+
+/**
+ * @brief Render a frame strip by strip while transmitting the previous one
+ *
+ * The callback renders strip N+1 while strip N is still on the bus. Without
+ * CONFIG_SH1106_FRAMEBUFFER the handle keeps only two strip buffers; with it
+ * the strips are windows into handle->buffer. Overlap needs a queued
+ * transport (SPI); on I2C transfers are synchronous.
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param draw Draw callback (NULL renders a blank frame)
+ * @param ctx User context passed to the callback
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_render_strips(sh1106_handle_t *handle,
+                               sh1106_strip_draw_cb_t draw, void *ctx);
+
+/**
+ * @brief Set or clear a pixel inside a strip
+ *
+ * @param strip Strip being rendered
+ * @param x X position (0-127)
+ * @param y Y position in display rows
+ * @param on Pixel state
+ */
+void sh1106_strip_set_pixel(sh1106_strip_t *strip, uint8_t x, uint8_t y,
+                            bool on);
+
+/**
+ * @brief Fill a rectangle, clipped to the strip
+ *
+ * @param strip Strip being rendered
+ * @param x Left edge
+ * @param y Top edge in display rows
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param on Pixel state
+ */
+void sh1106_strip_fill_rect(sh1106_strip_t *strip, uint8_t x, uint8_t y,
+                            uint8_t w, uint8_t h, bool on);
+
+/**
+ * @brief Draw text at any pixel row, clipped to the strip
+ *
+ * @param strip Strip being rendered
+ * @param font_type Font to use
+ * @param text Text string to display
+ * @param x X position (column)
+ * @param y Y position of the glyph top in display rows
+ */
+void sh1106_strip_draw_text(sh1106_strip_t *strip,
+                            sh1106_font_type_t font_type, const char *text,
+                            uint8_t x, uint8_t y);
+
+#endif // SH1106_STRIP_H
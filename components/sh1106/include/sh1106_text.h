@@ -0,0 +1,123 @@
+#ifndef SH1106_TEXT_H
+#define SH1106_TEXT_H
+
+#include "sh1106.h"
+#include "sh1106_fonts.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SH1106_TEXT_MAX_LINES 16   // 128 portrait rows of the 8-row fonts
+#define SH1106_TEXT_CACHE_SIZE 256 // Longest cached text, with its NUL
+
+typedef enum {
+  SH1106_ALIGN_LEFT = 0,
+  SH1106_ALIGN_CENTER,
+  SH1106_ALIGN_RIGHT,
+  SH1106_ALIGN_JUSTIFY, // Widen spaces to fill wrapped lines
+} sh1106_align_t;
+
+// Text box configuration
+typedef struct {
+  sh1106_font_type_t font; // Font to use
+  sh1106_align_t align;    // Horizontal alignment of each line
+  uint8_t line_spacing;    // Blank pixel rows between lines
+  bool ellipsis;           // End the last line with "..." if text is cut
+} sh1106_text_config_t;
+
+#define SH1106_TEXT_CONFIG_DEFAULT()                                           \
+  {                                                                            \
+    .font = FONT_8X8_DEFAULT, .align = SH1106_ALIGN_LEFT, .line_spacing = 0,   \
+    .ellipsis = true,                                                          \
+  }
+
+#define SH1106_TEXT_LINE_JUSTIFY 0x01  // Wrapped line, spaces may widen
+#define SH1106_TEXT_LINE_ELLIPSIS 0x02 // Followed by "..."
+
+// One laid-out line
+typedef struct {
+  uint16_t start; // Offset of the first character in the text
+  uint16_t len;   // Characters, trailing spaces trimmed
+  uint8_t width;  // Width in pixels including any ellipsis
+  uint8_t flags;  // SH1106_TEXT_LINE_*
+} sh1106_text_line_t;
+
+// Word-wrapped text in a pixel box. The line breaks are cached against a
+// copy of the text, so drawing the same text again costs one compare and no
+// pixels or dirty marks. Longer texts than SH1106_TEXT_CACHE_SIZE - 1 bytes
+// are laid out and drawn on every call.
+typedef struct {
+  sh1106_handle_t *display;
+  sh1106_text_config_t config;
+  const sh1106_font_t *font;
+  uint8_t x;      // Box left edge
+  uint8_t y;      // Box top row (any pixel row)
+  uint8_t width;  // Box width in pixels
+  uint8_t height; // Box height in pixels
+  // Text the cached layout belongs to
+  char text[SH1106_TEXT_CACHE_SIZE];
+  uint16_t text_len;
+  bool valid;    // Layout matches text/text_len
+  bool drawn;    // Layout is on the framebuffer
+  bool overflow; // Text did not fit in the box
+  uint8_t line_count;
+  sh1106_text_line_t lines[SH1106_TEXT_MAX_LINES];
+} sh1106_text_box_t;
+
+/**
+ * @brief Measure text without drawing it
+ *
+ * Characters the font lacks are skipped, as when drawing.
+ *
+ * @param font_type Font to measure with
+ * @param text Text, may contain '\n'
+ * @return uint16_t Width of the widest line in pixels
+ */
+uint16_t sh1106_text_width(sh1106_font_type_t font_type, const char *text);
+
+/**
+ * @brief Initialize a text box
+ *
+ * @param box Pointer to text box
+ * @param handle Pointer to SH1106 handle
+ * @param config Font, alignment and spacing (NULL for defaults)
+ * @param x Left edge (column)
+ * @param y Top edge (pixel row)
+ * @param width Width in pixels (clipped to the display)
+ * @param height Height in pixels (clipped to the display)
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_text_box_init(sh1106_text_box_t *box, sh1106_handle_t *handle,
+                               const sh1106_text_config_t *config, uint8_t x,
+                               uint8_t y, uint8_t width, uint8_t height);
+
+/**
+ * @brief Compute (or reuse) the line breaks for a text without drawing
+ *
+ * Afterwards line_count, lines and overflow describe the layout.
+ *
+ * @param box Pointer to text box
+ * @param text Text, '\n' starts a new paragraph
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_text_box_layout(sh1106_text_box_t *box, const char *text);
+
+/**
+ * @brief Draw text into the box
+ *
+ * Does nothing if the box already shows this text. Otherwise the box is
+ * cleared, the text drawn and the box marked dirty.
+ *
+ * @param box Pointer to text box
+ * @param text Text, '\n' starts a new paragraph
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_text_box_draw(sh1106_text_box_t *box, const char *text);
+
+/**
+ * @brief Force the next draw to render, e.g. after the display was cleared
+ *
+ * @param box Pointer to text box
+ */
+void sh1106_text_box_invalidate(sh1106_text_box_t *box);
+
+#endif // SH1106_TEXT_H
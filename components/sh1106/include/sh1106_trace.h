@@ -0,0 +1,119 @@
+#ifndef SH1106_TRACE_H
+#define SH1106_TRACE_H
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Trace event types. *_BEGIN/*_END pairs become duration slices in the
+// Chrome trace viewer, the rest are instant events.
+typedef enum {
+  SH1106_TRACE_TEXT_BEGIN = 0, // arg8: page
+  SH1106_TRACE_TEXT_END,       // arg8: page, arg16: columns drawn
+  SH1106_TRACE_CLEAR,          // arg8: first page, arg16: pages
+  SH1106_TRACE_FLUSH_BEGIN,    // arg8: sh1106_trace_flush_t
+  SH1106_TRACE_FLUSH_END,      // arg8: sh1106_trace_flush_t
+  SH1106_TRACE_PAGE_BEGIN,     // arg8: page, arg16: bytes
+  SH1106_TRACE_PAGE_END,       // arg8: page, arg16: bytes
+  SH1106_TRACE_BUS_ERROR,      // arg8: page or 0xFF, arg16: esp_err_t
+  SH1106_TRACE_USER,           // Free for application markers
+} sh1106_trace_type_t;
+
+// Which update path a flush event belongs to
+typedef enum {
+  SH1106_TRACE_FLUSH_FULL = 0, // sh1106_update_display()
+  SH1106_TRACE_FLUSH_DIRTY,    // sh1106_update_dirty()
+  SH1106_TRACE_FLUSH_STRIPS,   // sh1106_render_strips()
+} sh1106_trace_flush_t;
+
+// One recorded event; also the record layout of the binary stream
+typedef struct {
+  uint32_t ts_us; // Low 32 bits of esp_timer_get_time()
+  uint8_t type;   // sh1106_trace_type_t
+  uint8_t arg8;
+  uint16_t arg16;
+  uint32_t task; // Recording task (low 32 bits of its handle)
+} sh1106_trace_event_t;
+
+// Export formats
+typedef enum {
+  SH1106_TRACE_FORMAT_JSON = 0, // Chrome trace-event JSON
+  SH1106_TRACE_FORMAT_BINARY,   // "SHTR" header + raw little-endian events
+} sh1106_trace_format_t;
+
+#define SH1106_TRACE_MAGIC "SHTR"
+#define SH1106_TRACE_VERSION 2
+
+/**
+ * @brief Sink for sh1106_trace_dump() output
+ *
+ * @param data Bytes to write
+ * @param len Number of bytes
+ * @param ctx User context
+ */
+typedef void (*sh1106_trace_write_t)(const void *data, size_t len,
+                                     void *ctx);
+
+#if CONFIG_SH1106_TRACE
+
+// Trace point; compiles to nothing without CONFIG_SH1106_TRACE
+#define SH1106_TRACE(type, arg8, arg16)                                        \
+  sh1106_trace_record((type), (uint8_t)(arg8), (uint16_t)(arg16))
+
+/**
+ * @brief Record an event
+ *
+ * Lock-free and safe from any task or ISR; the oldest event is overwritten
+ * once the ring is full. Events carry the current task, which the JSON
+ * export uses as the thread, so begin/end pairs nest per task. Events from
+ * an ISR count for the task it interrupted.
+ *
+ * @param type Event type
+ * @param arg8 Small argument (see sh1106_trace_type_t)
+ * @param arg16 Larger argument (see sh1106_trace_type_t)
+ */
+void sh1106_trace_record(sh1106_trace_type_t type, uint8_t arg8,
+                         uint16_t arg16);
+
+/**
+ * @brief Record an event that happened earlier
+ *
+ * For work timed where recording is not possible, such as bus transfer
+ * callbacks. The ring then holds events out of timestamp order; the
+ * exports and the converter handle that.
+ *
+ * @param type Event type
+ * @param arg8 Small argument (see sh1106_trace_type_t)
+ * @param arg16 Larger argument (see sh1106_trace_type_t)
+ * @param ts_us When it happened (low 32 bits of esp_timer_get_time())
+ */
+void sh1106_trace_record_at(sh1106_trace_type_t type, uint8_t arg8,
+                            uint16_t arg16, uint32_t ts_us);
+
+/**
+ * @brief Drop all recorded events
+ */
+void sh1106_trace_reset(void);
+
+/**
+ * @brief Export recorded events, oldest first
+ *
+ * Events recorded while the dump runs may be torn or lost, so dump from a
+ * quiet point (or after the traced work has finished).
+ *
+ * @param format Output format
+ * @param write Output sink, called with chunks of the output
+ * @param ctx User context passed to the sink
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_trace_dump(sh1106_trace_format_t format,
+                            sh1106_trace_write_t write, void *ctx);
+
+#else
+
+#define SH1106_TRACE(type, arg8, arg16) ((void)0)
+
+#endif // CONFIG_SH1106_TRACE
+
+#endif // SH1106_TRACE_H
@@ -1,117 +1,553 @@
 #include "sh1106.h"
-#include "driver/i2c.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "sh1106_fonts.h"
+#include "sh1106_priv.h"
+#include "sh1106_strip.h"
 #include <string.h>
 
-static const char *TAG = "SH1106";
+#if SH1106_BUS_DRIVERS
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "driver/spi_master.h"
+#include "esp_attr.h"
+#endif
 
-static esp_err_t sh1106_write_command(sh1106_handle_t *handle, uint8_t cmd) {
-  uint8_t data[2] = {0x00, cmd}; // 0x00 = command mode
+static const char *TAG = "SH1106";
 
-  i2c_cmd_handle_t i2c_cmd = i2c_cmd_link_create();
+// COM pin layout of the glass
+#if SH1106_HEIGHT == 32
+#define SH1106_INIT_COM_PINS 0x02 // Sequential
+#else
+#define SH1106_INIT_COM_PINS 0x12 // Alternative
+#endif
+
+// Most address commands sent ahead of page data (SSD1306 column and page
+// windows)
+#define SH1106_ADDR_CMDS_MAX 6
+
+// Power-up sequence, sent as one command stream
+static const uint8_t sh1106_init_cmds[] = {
+    SH1106_CMD_DISPLAY_OFF,
+    SH1106_CMD_SET_CLOCK_DIV, 0x80,
+    SH1106_CMD_SET_MULTIPLEX, SH1106_HEIGHT - 1,
+    SH1106_CMD_SET_DISPLAY_OFFSET, 0x00,
+    0x40, // Set start line
+    SH1106_CMD_SET_CHARGE_PUMP, 0x14, // Enable charge pump
+#if SH1106_CONTROLLER_SSD1306
+    SH1106_CMD_SET_MEMORY_MODE, 0x00, // Horizontal addressing
+#endif
+    SH1106_CMD_SET_SEGMENT_REMAP,
+    SH1106_CMD_SET_SCAN_DIRECTION,
+    SH1106_CMD_SET_COM_PINS, SH1106_INIT_COM_PINS,
+    SH1106_CMD_SET_CONTRAST, SH1106_DEFAULT_CONTRAST,
+    SH1106_CMD_SET_PRECHARGE, 0xF1,
+    SH1106_CMD_SET_VCOM_DESELECT, 0x40,
+    0xA4, // Display RAM content
+    0xA6, // Normal display (not inverted)
+    SH1106_CMD_DISPLAY_ON,
+};
+
+#if SH1106_BUS_DRIVERS
+
+// ============================================================================
+// I2C transport
+// ============================================================================
+
+static esp_err_t sh1106_i2c_write_cmds(void *ctx, const uint8_t *cmds,
+                                       size_t len) {
+  sh1106_handle_t *handle = (sh1106_handle_t *)ctx;
+
+  uint8_t link_buf[I2C_LINK_RECOMMENDED_SIZE(1)];
+  i2c_cmd_handle_t i2c_cmd =
+      i2c_cmd_link_create_static(link_buf, sizeof(link_buf));
   i2c_master_start(i2c_cmd);
   i2c_master_write_byte(i2c_cmd, (handle->i2c_address << 1) | I2C_MASTER_WRITE,
                         true);
-  i2c_master_write(i2c_cmd, data, 2, true);
+  i2c_master_write_byte(i2c_cmd, 0x00, true); // 0x00 = command stream
+  i2c_master_write(i2c_cmd, cmds, len, true);
   i2c_master_stop(i2c_cmd);
 
   esp_err_t ret = i2c_master_cmd_begin(handle->i2c_port, i2c_cmd,
                                        pdMS_TO_TICKS(SH1106_I2C_TIMEOUT_MS));
-  i2c_cmd_link_delete(i2c_cmd);
+  i2c_cmd_link_delete_static(i2c_cmd);
+  sh1106_i2c_account(handle, ret);
 
   return ret;
 }
 
-static esp_err_t sh1106_write_data(sh1106_handle_t *handle, uint8_t *data,
-                                   size_t len) {
-  i2c_cmd_handle_t i2c_cmd = i2c_cmd_link_create();
+static esp_err_t sh1106_i2c_write_page(void *ctx, const uint8_t *cmds,
+                                       size_t cmd_len, const uint8_t *data,
+                                       size_t len) {
+  sh1106_handle_t *handle = (sh1106_handle_t *)ctx;
+
+  // Each command byte is preceded by a 0x80 control byte (Co=1, D/C=0) so
+  // that the data stream (0x40) can follow in the same transaction
+  uint8_t ctrl_cmds[2 * SH1106_ADDR_CMDS_MAX];
+  size_t n = 0;
+  for (size_t i = 0; i < cmd_len && n + 2 <= sizeof(ctrl_cmds); i++) {
+    ctrl_cmds[n++] = 0x80;
+    ctrl_cmds[n++] = cmds[i];
+  }
+
+  // Static command link keeps the hot path free of heap allocations
+  uint8_t link_buf[I2C_LINK_RECOMMENDED_SIZE(2)];
+  i2c_cmd_handle_t i2c_cmd =
+      i2c_cmd_link_create_static(link_buf, sizeof(link_buf));
   i2c_master_start(i2c_cmd);
   i2c_master_write_byte(i2c_cmd, (handle->i2c_address << 1) | I2C_MASTER_WRITE,
                         true);
+  i2c_master_write(i2c_cmd, ctrl_cmds, n, true);
   i2c_master_write_byte(i2c_cmd, 0x40, true); // 0x40 = data mode
   i2c_master_write(i2c_cmd, data, len, true);
   i2c_master_stop(i2c_cmd);
 
   esp_err_t ret = i2c_master_cmd_begin(handle->i2c_port, i2c_cmd,
                                        pdMS_TO_TICKS(SH1106_I2C_TIMEOUT_MS));
-  i2c_cmd_link_delete(i2c_cmd);
+  i2c_cmd_link_delete_static(i2c_cmd);
+  sh1106_i2c_account(handle, ret);
+
+  return ret;
+}
+
+static const sh1106_transport_t sh1106_i2c_transport = {
+    .write_cmds = sh1106_i2c_write_cmds,
+    .write_page = sh1106_i2c_write_page,
+    .wait = NULL,
+};
+
+// ============================================================================
+// SPI transport
+// ============================================================================
+
+// The D/C pin and level travel in the transaction's user field because the
+// pre-transfer callback gets no device context
+#define SH1106_SPI_USER(pin, dc) ((void *)(intptr_t)(((pin) << 1) | (dc)))
+
+// Page of a command-only transfer
+#define SH1106_SPI_NO_PAGE 0xFF
+
+static void IRAM_ATTR sh1106_spi_pre_cb(spi_transaction_t *t) {
+  intptr_t user = (intptr_t)t->user;
+  gpio_set_level((gpio_num_t)(user >> 1), user & 1);
+#if CONFIG_SH1106_TRACE
+  ((sh1106_spi_slot_t *)t)->begin_us = (uint32_t)esp_timer_get_time();
+#endif
+}
+
+#if CONFIG_SH1106_TRACE
+static void IRAM_ATTR sh1106_spi_post_cb(spi_transaction_t *t) {
+  ((sh1106_spi_slot_t *)t)->end_us = (uint32_t)esp_timer_get_time();
+}
+#endif
+
+// Collect the oldest finished transfer. Pixel transfers are traced here,
+// with the times they actually ran on the bus, since queueing returns long
+// before that.
+static esp_err_t sh1106_spi_reap(sh1106_handle_t *handle) {
+  spi_transaction_t *done;
+  esp_err_t ret =
+      spi_device_get_trans_result(handle->spi_dev, &done, portMAX_DELAY);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  handle->spi_inflight--;
+
+#if CONFIG_SH1106_TRACE
+  const sh1106_spi_slot_t *slot = (const sh1106_spi_slot_t *)done;
+  if (slot->page != SH1106_SPI_NO_PAGE) {
+    uint16_t bytes = done->length / 8;
+    sh1106_trace_record_at(SH1106_TRACE_PAGE_BEGIN, slot->page, bytes,
+                           slot->begin_us);
+    sh1106_trace_record_at(SH1106_TRACE_PAGE_END, slot->page, bytes,
+                           slot->end_us);
+  }
+#endif
+  return ESP_OK;
+}
+
+static esp_err_t sh1106_spi_wait(void *ctx) {
+  sh1106_handle_t *handle = (sh1106_handle_t *)ctx;
+
+  while (handle->spi_inflight > 0) {
+    esp_err_t ret = sh1106_spi_reap(handle);
+    if (ret != ESP_OK) {
+      return ret;
+    }
+  }
 
+  return ESP_OK;
+}
+
+// Take the next transaction slot, reaping the oldest one if the ring is
+// full. The slot only counts as used once sh1106_spi_queue() has queued it,
+// so the spi_inflight slots before spi_slot_next are the driver's.
+static sh1106_spi_slot_t *sh1106_spi_slot(sh1106_handle_t *handle) {
+  if (handle->spi_inflight == SH1106_SPI_QUEUE_SIZE &&
+      sh1106_spi_reap(handle) != ESP_OK) {
+    return NULL;
+  }
+
+  sh1106_spi_slot_t *slot = &handle->spi_slot[handle->spi_slot_next];
+  memset(slot, 0, sizeof(*slot));
+  return slot;
+}
+
+// Page addressed by the commands sh1106_write_page() puts ahead of the data
+static uint8_t sh1106_spi_cmds_page(const uint8_t *cmds) {
+#if SH1106_CONTROLLER_SSD1306
+  return cmds[4]; // Page range start
+#else
+  return cmds[0] & 0x0F;
+#endif
+}
+
+static esp_err_t sh1106_spi_queue(sh1106_handle_t *handle, const uint8_t *buf,
+                                  size_t len, int dc, uint8_t page) {
+  sh1106_spi_slot_t *slot = sh1106_spi_slot(handle);
+  if (slot == NULL) {
+    return ESP_FAIL;
+  }
+#if CONFIG_SH1106_TRACE
+  slot->page = page;
+#endif
+
+  spi_transaction_t *t = &slot->trans;
+  t->length = len * 8;
+  t->user = SH1106_SPI_USER(handle->spi_dc_pin, dc);
+  if (len <= sizeof(t->tx_data)) {
+    // Short command runs travel inside the descriptor
+    t->flags = SPI_TRANS_USE_TXDATA;
+    memcpy(t->tx_data, buf, len);
+  } else {
+    t->tx_buffer = buf;
+  }
+
+  esp_err_t ret = spi_device_queue_trans(handle->spi_dev, t, portMAX_DELAY);
+  if (ret == ESP_OK) {
+    handle->spi_slot_next = (handle->spi_slot_next + 1) % SH1106_SPI_QUEUE_SIZE;
+    handle->spi_inflight++;
+  }
   return ret;
 }
 
+static esp_err_t sh1106_spi_write_cmds(void *ctx, const uint8_t *cmds,
+                                       size_t len) {
+  sh1106_handle_t *handle = (sh1106_handle_t *)ctx;
+
+  esp_err_t ret = sh1106_spi_queue(handle, cmds, len, 0, SH1106_SPI_NO_PAGE);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  // Caller's buffer may be on its stack, so finish before returning
+  return sh1106_spi_wait(handle);
+}
+
+static esp_err_t sh1106_spi_write_page(void *ctx, const uint8_t *cmds,
+                                       size_t cmd_len, const uint8_t *data,
+                                       size_t len) {
+  sh1106_handle_t *handle = (sh1106_handle_t *)ctx;
+
+  // Address commands are copied into descriptors (4 bytes each) since the
+  // caller's array is gone before they are sent; pixel data is one DMA
+  // transfer straight from the caller's buffer
+  esp_err_t ret = ESP_OK;
+  const size_t chunk = sizeof(((spi_transaction_t *)0)->tx_data);
+  for (size_t i = 0; i < cmd_len && ret == ESP_OK; i += chunk) {
+    ret = sh1106_spi_queue(handle, &cmds[i],
+                           cmd_len - i < chunk ? cmd_len - i : chunk, 0,
+                           SH1106_SPI_NO_PAGE);
+  }
+  if (ret == ESP_OK) {
+    ret = sh1106_spi_queue(handle, data, len, 1, sh1106_spi_cmds_page(cmds));
+  }
+  return ret;
+}
+
+static const sh1106_transport_t sh1106_spi_transport = {
+    .write_cmds = sh1106_spi_write_cmds,
+    .write_page = sh1106_spi_write_page,
+    .wait = sh1106_spi_wait,
+};
+
+#endif // SH1106_BUS_DRIVERS
+
+// ============================================================================
+// Transport-independent bus helpers
+// ============================================================================
+
+// Hand one page transfer to the transport. The SPI transport traces pages
+// itself when they complete; others are traced around the call.
+static esp_err_t sh1106_send_page(sh1106_handle_t *handle, uint8_t page,
+                                  const uint8_t *cmds, size_t cmd_len,
+                                  const uint8_t *data, size_t len) {
+#if SH1106_BUS_DRIVERS
+  bool traced = handle->transport != &sh1106_spi_transport;
+#else
+  bool traced = true;
+#endif
+
+  if (traced) {
+    SH1106_TRACE(SH1106_TRACE_PAGE_BEGIN, page, len);
+  }
+  esp_err_t ret = handle->transport->write_page(handle->transport_ctx, cmds,
+                                                cmd_len, data, len);
+  if (traced) {
+    SH1106_TRACE(SH1106_TRACE_PAGE_END, page, len);
+  }
+  if (ret != ESP_OK) {
+    SH1106_TRACE(SH1106_TRACE_BUS_ERROR, page, ret);
+  }
+  return ret;
+}
+
+esp_err_t sh1106_write_commands(sh1106_handle_t *handle, const uint8_t *cmds,
+                                size_t len) {
+  esp_err_t ret = handle->transport->write_cmds(handle->transport_ctx, cmds,
+                                                len);
+  if (ret != ESP_OK) {
+    SH1106_TRACE(SH1106_TRACE_BUS_ERROR, 0xFF, ret);
+  }
+  return ret;
+}
+
+esp_err_t sh1106_write_page(sh1106_handle_t *handle, uint8_t page, uint8_t col,
+                            const uint8_t *data, size_t len) {
+  uint8_t ram_col = col + SH1106_COLUMN_OFFSET;
+
+#if SH1106_CONTROLLER_SSD1306
+  // Horizontal addressing: the data fills a one-page window
+  uint8_t cmds[6] = {
+      SH1106_CMD_SET_COLUMN_RANGE, ram_col, ram_col + len - 1,
+      SH1106_CMD_SET_PAGE_RANGE,   page,    page,
+  };
+#else
+  uint8_t cmds[3] = {
+      SH1106_CMD_SET_PAGE_ADDR | page,
+      SH1106_CMD_SET_LOW_COLUMN | (ram_col & 0x0F),
+      SH1106_CMD_SET_HIGH_COLUMN | (ram_col >> 4),
+  };
+#endif
+
+  return sh1106_send_page(handle, page, cmds, sizeof(cmds), data, len);
+}
+
+esp_err_t sh1106_write_pages(sh1106_handle_t *handle, uint8_t page,
+                             uint8_t pages, const uint8_t *data) {
+#if SH1106_CONTROLLER_SSD1306
+  // The window wraps from the last column to the next page, which is
+  // exactly the page-major buffer layout
+  uint8_t cmds[6] = {
+      SH1106_CMD_SET_COLUMN_RANGE,
+      SH1106_COLUMN_OFFSET,
+      SH1106_COLUMN_OFFSET + SH1106_WIDTH - 1,
+      SH1106_CMD_SET_PAGE_RANGE,
+      page,
+      page + pages - 1,
+  };
+  size_t len = (size_t)pages * SH1106_WIDTH;
+
+  return sh1106_send_page(handle, page, cmds, sizeof(cmds), data, len);
+#else
+  // Page addressing: one transaction per page
+  esp_err_t ret = ESP_OK;
+  for (uint8_t i = 0; i < pages; i++) {
+    esp_err_t err = sh1106_write_page(handle, page + i, 0,
+                                      data + (size_t)i * SH1106_WIDTH,
+                                      SH1106_WIDTH);
+    if (err != ESP_OK) {
+      ret = err;
+    }
+  }
+  return ret;
+#endif
+}
+
+esp_err_t sh1106_wait_idle(sh1106_handle_t *handle) {
+  if (handle->transport->wait == NULL) {
+    return ESP_OK;
+  }
+  esp_err_t ret = handle->transport->wait(handle->transport_ctx);
+  if (ret != ESP_OK) {
+    SH1106_TRACE(SH1106_TRACE_BUS_ERROR, 0xFF, ret);
+  }
+  return ret;
+}
+
+// ============================================================================
+// Initialization
+// ============================================================================
+
+static esp_err_t sh1106_init_panel(sh1106_handle_t *handle) {
+  handle->current_font = sh1106_get_font(FONT_8X8_DEFAULT); // Set default font
+  handle->rotation = SH1106_ROTATION_0;
+  handle->width = SH1106_WIDTH;
+  handle->height = SH1106_HEIGHT;
+#if SH1106_BUS_DRIVERS
+  handle->i2c_fallback = false;
+  handle->i2c_window_xfers = 0;
+  handle->i2c_window_errors = 0;
+  handle->i2c_errors = 0;
+#endif
+  handle->frame_us = 0;
+
+  // Initialize display
+  vTaskDelay(pdMS_TO_TICKS(100)); // Wait for display to power up
+
+  esp_err_t ret = sh1106_write_commands(handle, sh1106_init_cmds,
+                                        sizeof(sh1106_init_cmds));
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Display did not accept init sequence");
+    return ret;
+  }
+
+#if CONFIG_SH1106_FRAMEBUFFER
+  // Clear buffer; panel RAM content is unknown so everything starts dirty
+  memset(handle->buffer, 0, sizeof(handle->buffer));
+  memset(handle->dirty_start, 0, sizeof(handle->dirty_start));
+  memset(handle->dirty_end, SH1106_WIDTH, sizeof(handle->dirty_end));
+#endif
+
+  ESP_LOGI(TAG, "SH1106 initialized successfully");
+  return ESP_OK;
+}
+
+#if SH1106_BUS_DRIVERS
 esp_err_t sh1106_init(sh1106_handle_t *handle, i2c_port_t i2c_port,
                       gpio_num_t sda_pin, gpio_num_t scl_pin,
                       uint32_t i2c_freq) {
   esp_err_t ret;
 
   // Configure I2C
-  i2c_config_t conf = {
-      .mode = I2C_MODE_MASTER,
-      .sda_io_num = sda_pin,
-      .scl_io_num = scl_pin,
-      .sda_pullup_en = GPIO_PULLUP_ENABLE,
-      .scl_pullup_en = GPIO_PULLUP_ENABLE,
-      .master.clk_speed = i2c_freq,
-  };
+  handle->i2c_port = i2c_port;
+  handle->i2c_sda_pin = sda_pin;
+  handle->i2c_scl_pin = scl_pin;
 
-  ret = i2c_param_config(i2c_port, &conf);
+  ret = sh1106_i2c_set_clock(handle, i2c_freq);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "I2C param config failed");
     return ret;
   }
 
-  ret = i2c_driver_install(i2c_port, conf.mode, 0, 0, 0);
+  ret = i2c_driver_install(i2c_port, I2C_MODE_MASTER, 0, 0, 0);
   if (ret != ESP_OK) {
     ESP_LOGE(TAG, "I2C driver install failed");
     return ret;
   }
 
-  handle->i2c_port = i2c_port;
   handle->i2c_address = SH1106_I2C_ADDRESS;
-  handle->current_font = sh1106_get_font(FONT_8X8_DEFAULT); // Set default font
+  handle->transport = &sh1106_i2c_transport;
+  handle->transport_ctx = handle;
 
-  // Initialize display
-  vTaskDelay(pdMS_TO_TICKS(100)); // Wait for display to power up
+  return sh1106_init_panel(handle);
+}
 
-  sh1106_write_command(handle, SH1106_CMD_DISPLAY_OFF);
-  sh1106_write_command(handle, SH1106_CMD_SET_CLOCK_DIV);
-  sh1106_write_command(handle, 0x80);
-  sh1106_write_command(handle, SH1106_CMD_SET_MULTIPLEX);
-  sh1106_write_command(handle, 0x3F);
-  sh1106_write_command(handle, SH1106_CMD_SET_DISPLAY_OFFSET);
-  sh1106_write_command(handle, 0x00);
-  sh1106_write_command(handle, 0x40); // Set start line
-  sh1106_write_command(handle, SH1106_CMD_SET_CHARGE_PUMP);
-  sh1106_write_command(handle, 0x14); // Enable charge pump
-  sh1106_write_command(handle, SH1106_CMD_SET_SEGMENT_REMAP);
-  sh1106_write_command(handle, SH1106_CMD_SET_SCAN_DIRECTION);
-  sh1106_write_command(handle, SH1106_CMD_SET_COM_PINS);
-  sh1106_write_command(handle, 0x12);
-  sh1106_write_command(handle, SH1106_CMD_SET_CONTRAST);
-  sh1106_write_command(handle, 0xCF);
-  sh1106_write_command(handle, SH1106_CMD_SET_PRECHARGE);
-  sh1106_write_command(handle, 0xF1);
-  sh1106_write_command(handle, SH1106_CMD_SET_VCOM_DESELECT);
-  sh1106_write_command(handle, 0x40);
-  sh1106_write_command(handle, 0xA4); // Display RAM content
-  sh1106_write_command(handle, 0xA6); // Normal display (not inverted)
-  sh1106_write_command(handle, SH1106_CMD_DISPLAY_ON);
-
-  // Clear buffer
-  memset(handle->buffer, 0, sizeof(handle->buffer));
+esp_err_t sh1106_init_spi(sh1106_handle_t *handle,
+                          const sh1106_spi_config_t *config) {
+  if (handle == NULL || config == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
 
-  ESP_LOGI(TAG, "SH1106 initialized successfully");
-  return ESP_OK;
+  esp_err_t ret;
+
+  if (!config->bus_initialized) {
+    spi_bus_config_t bus = {
+        .mosi_io_num = config->mosi_pin,
+        .miso_io_num = -1,
+        .sclk_io_num = config->sclk_pin,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        // A full frame is one transfer with horizontal addressing
+        .max_transfer_sz = SH1106_CONTROLLER_SSD1306
+                               ? SH1106_PAGES * SH1106_WIDTH
+                               : SH1106_WIDTH,
+    };
+    ret = spi_bus_initialize(config->host, &bus, SPI_DMA_CH_AUTO);
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG, "SPI bus init failed");
+      return ret;
+    }
+  }
+
+  gpio_config_t io = {
+      .pin_bit_mask = 1ULL << config->dc_pin,
+      .mode = GPIO_MODE_OUTPUT,
+  };
+  if (config->rst_pin != GPIO_NUM_NC) {
+    io.pin_bit_mask |= 1ULL << config->rst_pin;
+  }
+  ret = gpio_config(&io);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "D/C or RST GPIO config failed");
+    return ret;
+  }
+
+  spi_device_interface_config_t dev = {
+      .mode = 0,
+      .clock_speed_hz = config->clock_hz,
+      .spics_io_num = config->cs_pin,
+      .queue_size = SH1106_SPI_QUEUE_SIZE,
+      .pre_cb = sh1106_spi_pre_cb,
+#if CONFIG_SH1106_TRACE
+      .post_cb = sh1106_spi_post_cb,
+#endif
+  };
+  ret = spi_bus_add_device(config->host, &dev, &handle->spi_dev);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "SPI device add failed");
+    return ret;
+  }
+
+  handle->spi_dc_pin = config->dc_pin;
+  handle->i2c_clk_hz = 0;
+  handle->spi_slot_next = 0;
+  handle->spi_inflight = 0;
+  handle->transport = &sh1106_spi_transport;
+  handle->transport_ctx = handle;
+
+  if (config->rst_pin != GPIO_NUM_NC) {
+    gpio_set_level(config->rst_pin, 0);
+    vTaskDelay(pdMS_TO_TICKS(10));
+    gpio_set_level(config->rst_pin, 1);
+  }
+
+  return sh1106_init_panel(handle);
+}
+#endif // SH1106_BUS_DRIVERS
+
+esp_err_t sh1106_init_transport(sh1106_handle_t *handle,
+                                const sh1106_transport_t *transport,
+                                void *ctx) {
+  if (handle == NULL || transport == NULL || transport->write_cmds == NULL ||
+      transport->write_page == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  handle->transport = transport;
+  handle->transport_ctx = ctx;
+#if SH1106_BUS_DRIVERS
+  handle->i2c_clk_hz = 0;
+#endif
+
+  return sh1106_init_panel(handle);
 }
 
 esp_err_t sh1106_clear_display(sh1106_handle_t *handle) {
+  SH1106_TRACE(SH1106_TRACE_CLEAR, 0, SH1106_PAGES);
+#if CONFIG_SH1106_FRAMEBUFFER
   memset(handle->buffer, 0, sizeof(handle->buffer));
   return sh1106_update_display(handle);
+#else
+  // Strips start cleared, so rendering without a callback blanks the panel
+  return sh1106_render_strips(handle, NULL, NULL);
+#endif
 }
 
+#if CONFIG_SH1106_FRAMEBUFFER
+
 esp_err_t sh1106_clear_section(sh1106_handle_t *handle,
                                sh1106_section_t section) {
   uint8_t start_page, num_pages;
@@ -133,9 +569,20 @@ esp_err_t sh1106_clear_section(sh1106_handle_t *handle,
     return ESP_ERR_INVALID_ARG;
   }
 
+  // Short panels have no footer and a partial body
+  uint8_t pages = handle->height / 8;
+  if (start_page >= pages) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (num_pages > pages - start_page) {
+    num_pages = pages - start_page;
+  }
+
+  SH1106_TRACE(SH1106_TRACE_CLEAR, start_page, num_pages);
   for (uint8_t page = start_page; page < start_page + num_pages; page++) {
-    memset(handle->buffer[page], 0, SH1106_WIDTH);
+    memset(sh1106_fb_row(handle, page), 0, handle->width);
   }
+  sh1106_mark_dirty(handle, 0, start_page, handle->width, num_pages);
 
   return ESP_OK;
 }
@@ -167,8 +614,18 @@ esp_err_t sh1106_write_text_offset(sh1106_handle_t *handle,
   const sh1106_font_t *font = handle->current_font;
   uint8_t page = start_page + y;
   uint8_t col = x;
+  uint8_t pages = handle->height / 8;
 
-  for (size_t i = 0; text[i] != '\0' && col < SH1106_WIDTH; i++) {
+  if (page >= pages) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  SH1106_TRACE(SH1106_TRACE_TEXT_BEGIN, page, 0);
+  uint8_t *row = sh1106_fb_row(handle, page);
+  uint8_t *next_row = (page + 1 < pages) ? sh1106_fb_row(handle, page + 1)
+                                         : NULL;
+
+  for (size_t i = 0; text[i] != '\0' && col < handle->width; i++) {
     uint8_t c = text[i];
     if (c >= font->first_char && c <= font->last_char) {
       // Calculate font data index
@@ -176,7 +633,7 @@ esp_err_t sh1106_write_text_offset(sh1106_handle_t *handle,
       const uint8_t *char_data = font->data + char_index;
 
       // Copy font character to buffer with vertical offset
-      for (uint8_t j = 0; j < font->width && col < SH1106_WIDTH; j++) {
+      for (uint8_t j = 0; j < font->width && col < handle->width; j++) {
         uint8_t font_data = char_data[j];
 
         if (v_offset > 0) {
@@ -184,18 +641,23 @@ esp_err_t sh1106_write_text_offset(sh1106_handle_t *handle,
           uint8_t upper_bits = font_data << v_offset;
           uint8_t lower_bits = font_data >> (8 - v_offset);
 
-          handle->buffer[page][col] |= upper_bits;
-          if (page + 1 < SH1106_PAGES) {
-            handle->buffer[page + 1][col] |= lower_bits;
+          row[col] |= upper_bits;
+          if (next_row != NULL) {
+            next_row[col] |= lower_bits;
           }
         } else {
-          handle->buffer[page][col] = font_data;
+          row[col] = font_data;
         }
         col++;
       }
     }
   }
 
+  if (col > x) {
+    sh1106_mark_dirty(handle, x, page, col - x, v_offset > 0 ? 2 : 1);
+  }
+  SH1106_TRACE(SH1106_TRACE_TEXT_END, page, col - x);
+
   return ESP_OK;
 }
 
@@ -204,25 +666,153 @@ esp_err_t sh1106_write_text(sh1106_handle_t *handle, sh1106_section_t section,
   return sh1106_write_text_offset(handle, section, text, x, y, 0);
 }
 
+// Send columns [start, end) of a panel page from the framebuffer
+static esp_err_t sh1106_flush_span(sh1106_handle_t *handle, uint8_t page,
+                                   uint8_t start, uint8_t end) {
+  if (sh1106_is_portrait(handle)) {
+    return sh1106_rotate_write_page(handle, page, start, end);
+  }
+  return sh1106_write_page(handle, page, start, &handle->buffer[page][start],
+                           end - start);
+}
+
 esp_err_t sh1106_update_display(sh1106_handle_t *handle) {
+  esp_err_t ret = ESP_OK;
+  int64_t start = esp_timer_get_time();
+  SH1106_TRACE(SH1106_TRACE_FLUSH_BEGIN, SH1106_TRACE_FLUSH_FULL, 0);
+
+  if (sh1106_is_portrait(handle)) {
+    for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+      esp_err_t err = sh1106_flush_span(handle, page, 0, SH1106_WIDTH);
+      if (err != ESP_OK) {
+        ret = err;
+      }
+    }
+  } else {
+    // One transaction per page, or one for the frame on the SSD1306
+    ret = sh1106_write_pages(handle, 0, SH1106_PAGES, &handle->buffer[0][0]);
+  }
+  memset(handle->dirty_start, SH1106_WIDTH, sizeof(handle->dirty_start));
+  memset(handle->dirty_end, 0, sizeof(handle->dirty_end));
+
+  esp_err_t err = sh1106_wait_idle(handle);
+  SH1106_TRACE(SH1106_TRACE_FLUSH_END, SH1106_TRACE_FLUSH_FULL, 0);
+  handle->frame_us = (uint32_t)(esp_timer_get_time() - start);
+  return ret != ESP_OK ? ret : err;
+}
+
+esp_err_t sh1106_update_dirty(sh1106_handle_t *handle) {
+  esp_err_t ret = ESP_OK;
+  SH1106_TRACE(SH1106_TRACE_FLUSH_BEGIN, SH1106_TRACE_FLUSH_DIRTY, 0);
+
   for (uint8_t page = 0; page < SH1106_PAGES; page++) {
-    // Set page address
-    sh1106_write_command(handle, SH1106_CMD_SET_PAGE_ADDR | page);
+    uint8_t start = handle->dirty_start[page];
+    uint8_t end = handle->dirty_end[page];
+    if (start >= end) {
+      continue;
+    }
 
-    // Set column address (SH1106 has 132 columns, display starts at column 2)
-    sh1106_write_command(handle, SH1106_CMD_SET_LOW_COLUMN | 0x02);
-    sh1106_write_command(handle, SH1106_CMD_SET_HIGH_COLUMN | 0x00);
+    esp_err_t err = sh1106_flush_span(handle, page, start, end);
+    if (err != ESP_OK) {
+      // Leave the span dirty so the next update retries it
+      ret = err;
+      continue;
+    }
+    handle->dirty_start[page] = SH1106_WIDTH;
+    handle->dirty_end[page] = 0;
+  }
 
-    // Write page data
-    sh1106_write_data(handle, handle->buffer[page], SH1106_WIDTH);
+  esp_err_t err = sh1106_wait_idle(handle);
+  SH1106_TRACE(SH1106_TRACE_FLUSH_END, SH1106_TRACE_FLUSH_DIRTY, 0);
+  return ret != ESP_OK ? ret : err;
+}
+
+void sh1106_mark_dirty(sh1106_handle_t *handle, uint8_t x, uint8_t page,
+                       uint8_t width, uint8_t pages) {
+  uint8_t num_pages = handle->height / 8;
+  if (x >= handle->width || page >= num_pages || width == 0 || pages == 0) {
+    return;
   }
 
-  return ESP_OK;
+  uint8_t end = (width > handle->width - x) ? handle->width : x + width;
+  uint8_t last_page = (pages > num_pages - page) ? num_pages : page + pages;
+
+  if (sh1106_is_portrait(handle)) {
+    // Dirty state is kept per panel page: logical column tiles map to panel
+    // pages and logical pages to mirrored 8-column panel tiles
+    uint8_t col_start = SH1106_WIDTH - last_page * 8;
+    uint8_t col_end = SH1106_WIDTH - page * 8;
+    page = x / 8;
+    last_page = (end + 7) / 8;
+    x = col_start;
+    end = col_end;
+  }
+
+  for (uint8_t p = page; p < last_page; p++) {
+    if (x < handle->dirty_start[p]) {
+      handle->dirty_start[p] = x;
+    }
+    if (end > handle->dirty_end[p]) {
+      handle->dirty_end[p] = end;
+    }
+  }
 }
 
+#endif // CONFIG_SH1106_FRAMEBUFFER
+
 esp_err_t sh1106_set_contrast(sh1106_handle_t *handle, uint8_t contrast) {
-  sh1106_write_command(handle, SH1106_CMD_SET_CONTRAST);
-  sh1106_write_command(handle, contrast);
+  uint8_t cmds[2] = {SH1106_CMD_SET_CONTRAST, contrast};
+  return sh1106_write_commands(handle, cmds, sizeof(cmds));
+}
+
+uint32_t sh1106_get_frame_time_us(const sh1106_handle_t *handle) {
+  return handle->frame_us;
+}
+
+esp_err_t sh1106_set_rotation(sh1106_handle_t *handle,
+                              sh1106_rotation_t rotation) {
+  if (handle == NULL || rotation > SH1106_ROTATION_270) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  bool portrait =
+      rotation == SH1106_ROTATION_90 || rotation == SH1106_ROTATION_270;
+#if !CONFIG_SH1106_FRAMEBUFFER
+  if (portrait) {
+    ESP_LOGE(TAG, "Portrait rotation needs CONFIG_SH1106_FRAMEBUFFER");
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+#endif
+#if SH1106_WIDTH % 8 != 0
+  if (portrait) {
+    ESP_LOGE(TAG, "Portrait rotation needs a width that is a multiple of 8");
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+#endif
+
+  // 180 and 270 run the panel flipped in both directions
+  bool flipped =
+      rotation == SH1106_ROTATION_180 || rotation == SH1106_ROTATION_270;
+  uint8_t cmds[2] = {
+      flipped ? SH1106_CMD_SET_SEGMENT_NORMAL : SH1106_CMD_SET_SEGMENT_REMAP,
+      flipped ? SH1106_CMD_SET_SCAN_NORMAL : SH1106_CMD_SET_SCAN_DIRECTION,
+  };
+  esp_err_t ret = sh1106_write_commands(handle, cmds, sizeof(cmds));
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  handle->rotation = rotation;
+  handle->width = portrait ? SH1106_HEIGHT : SH1106_WIDTH;
+  handle->height = portrait ? SH1106_WIDTH : SH1106_HEIGHT;
+
+#if CONFIG_SH1106_FRAMEBUFFER
+  // The buffer layout changed, so old content is meaningless
+  memset(handle->buffer, 0, sizeof(handle->buffer));
+  memset(handle->dirty_start, 0, sizeof(handle->dirty_start));
+  memset(handle->dirty_end, SH1106_WIDTH, sizeof(handle->dirty_end));
+#endif
+
   return ESP_OK;
 }
 
@@ -236,6 +826,7 @@ esp_err_t sh1106_set_font(sh1106_handle_t *handle,
   return ESP_OK;
 }
 
+#if CONFIG_SH1106_FRAMEBUFFER
 esp_err_t sh1106_write_text_font(sh1106_handle_t *handle,
                                  sh1106_section_t section, const char *text,
                                  uint8_t x, uint8_t y,
@@ -263,15 +854,14 @@ esp_err_t sh1106_write_text_centered(sh1106_handle_t *handle,
     return ESP_ERR_INVALID_ARG;
   }
 
-  // Calculate text width
-  const sh1106_font_t *font = handle->current_font;
-  size_t text_len = strlen(text);
-  uint16_t text_width = text_len * font->width;
+  // Characters the font lacks are not drawn, so they take no width
+  uint16_t text_width =
+      sh1106_font_text_width(handle->current_font, text, strlen(text));
 
   // Calculate starting X position for centering
   uint8_t x = 0;
-  if (text_width < SH1106_WIDTH) {
-    x = (SH1106_WIDTH - text_width) / 2;
+  if (text_width < handle->width) {
+    x = (handle->width - text_width) / 2;
   }
 
   return sh1106_write_text(handle, section, text, x, y);
@@ -295,4 +885,5 @@ esp_err_t sh1106_write_text_centered_font(sh1106_handle_t *handle,
   handle->current_font = original_font;
 
   return ret;
-}
\ No newline at end of file
+}
+#endif // CONFIG_SH1106_FRAMEBUFFER
@@ -0,0 +1,359 @@
+#include "sh1106_anim.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char *TAG = "SH1106_ANIM";
+
+static uint16_t anim_read_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t anim_read_u32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static esp_err_t anim_parse_header(sh1106_anim_t *anim) {
+  const uint8_t *d = anim->data;
+
+  if (anim->size < SH1106_ANIM_HEADER_SIZE ||
+      memcmp(d, SH1106_ANIM_MAGIC, 4) != 0) {
+    ESP_LOGE(TAG, "Not an animation file");
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (d[4] != SH1106_ANIM_VERSION) {
+    ESP_LOGE(TAG, "Unsupported animation version %u", d[4]);
+    return ESP_ERR_INVALID_VERSION;
+  }
+  if (d[5] != SH1106_WIDTH || d[6] != SH1106_PAGES) {
+    ESP_LOGE(TAG, "Animation is %ux%u, display is %ux%u", d[5], d[6] * 8,
+             SH1106_WIDTH, SH1106_HEIGHT);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  anim->flags = d[7];
+  anim->frame_count = anim_read_u16(d + 8);
+  anim->fps = anim_read_u16(d + 10);
+
+  size_t table_end =
+      SH1106_ANIM_HEADER_SIZE + (size_t)anim->frame_count * sizeof(uint32_t);
+  if (anim->frame_count == 0 || anim->fps == 0 || table_end > anim->size) {
+    ESP_LOGE(TAG, "Animation header is corrupt");
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  // Deltas need a base, so playback must start on a keyframe
+  uint32_t first = anim_read_u32(d + SH1106_ANIM_HEADER_SIZE);
+  if (first >= anim->size || d[first] != SH1106_ANIM_FRAME_KEY) {
+    ESP_LOGE(TAG, "First frame is not a keyframe");
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  anim->next_frame = 0;
+  memset(&anim->stats, 0, sizeof(anim->stats));
+  return ESP_OK;
+}
+
+esp_err_t sh1106_anim_open_memory(sh1106_anim_t *anim, const void *data,
+                                  size_t size) {
+  if (anim == NULL || data == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(anim, 0, sizeof(*anim));
+  anim->data = data;
+  anim->size = size;
+
+  return anim_parse_header(anim);
+}
+
+esp_err_t sh1106_anim_open_partition(sh1106_anim_t *anim, const char *label) {
+  if (anim == NULL || label == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(anim, 0, sizeof(*anim));
+
+  const esp_partition_t *part = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (part == NULL) {
+    ESP_LOGE(TAG, "Partition '%s' not found", label);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  const void *ptr;
+  esp_err_t ret = esp_partition_mmap(part, 0, part->size,
+                                     ESP_PARTITION_MMAP_DATA, &ptr,
+                                     &anim->mmap_handle);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to map partition '%s'", label);
+    return ret;
+  }
+
+  anim->data = ptr;
+  anim->size = part->size;
+  anim->partition_mapped = true;
+
+  ret = anim_parse_header(anim);
+  if (ret != ESP_OK) {
+    sh1106_anim_close(anim);
+  }
+  return ret;
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+esp_err_t sh1106_anim_open_file(sh1106_anim_t *anim, const char *path) {
+  if (anim == NULL || path == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(anim, 0, sizeof(*anim));
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    ESP_LOGE(TAG, "Cannot open %s", path);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  void *ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    ESP_LOGE(TAG, "Cannot map %s", path);
+    return ESP_FAIL;
+  }
+
+  anim->data = ptr;
+  anim->size = st.st_size;
+  anim->file_mapped = true;
+
+  esp_err_t ret = anim_parse_header(anim);
+  if (ret != ESP_OK) {
+    sh1106_anim_close(anim);
+  }
+  return ret;
+}
+#endif
+
+void sh1106_anim_close(sh1106_anim_t *anim) {
+  if (anim->partition_mapped) {
+    esp_partition_munmap(anim->mmap_handle);
+  }
+#if CONFIG_IDF_TARGET_LINUX
+  if (anim->file_mapped) {
+    munmap((void *)anim->data, anim->size);
+  }
+#endif
+
+  anim->data = NULL;
+  anim->size = 0;
+  anim->partition_mapped = false;
+  anim->file_mapped = false;
+}
+
+void sh1106_anim_rewind(sh1106_anim_t *anim) { anim->next_frame = 0; }
+
+static esp_err_t anim_apply_delta(sh1106_handle_t *handle, const uint8_t *p,
+                                  const uint8_t *end) {
+  if (end - p < 2) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  uint16_t spans = anim_read_u16(p);
+  p += 2;
+
+  for (uint16_t i = 0; i < spans; i++) {
+    if (end - p < 3) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t page = p[0];
+    uint8_t x = p[1];
+    uint8_t len = p[2];
+    p += 3;
+
+    if (page >= SH1106_PAGES || len > SH1106_WIDTH - x || end - p < len) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t *dst = &handle->buffer[page][x];
+    for (uint8_t j = 0; j < len; j++) {
+      dst[j] ^= p[j];
+    }
+    sh1106_mark_dirty(handle, x, page, len, 1);
+    p += len;
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_anim_decode_next(sh1106_anim_t *anim,
+                                  sh1106_handle_t *handle) {
+  if (anim->data == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (anim->next_frame >= anim->frame_count) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  // Frames are stored in the native 128x64 layout
+  if (sh1106_is_portrait(handle)) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  uint16_t index = anim->next_frame;
+  uint32_t offset = anim_read_u32(anim->data + SH1106_ANIM_HEADER_SIZE +
+                                  (size_t)index * sizeof(uint32_t));
+  // A frame ends where the next one starts (or at the end of the file)
+  size_t limit = anim->size;
+  if (index + 1 < anim->frame_count) {
+    limit = anim_read_u32(anim->data + SH1106_ANIM_HEADER_SIZE +
+                          (size_t)(index + 1) * sizeof(uint32_t));
+  }
+  if (offset >= limit || limit > anim->size) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  const uint8_t *p = anim->data + offset;
+  const uint8_t *end = anim->data + limit;
+  esp_err_t ret;
+
+  switch (p[0]) {
+  case SH1106_ANIM_FRAME_KEY:
+    if ((size_t)(end - p - 1) < sizeof(handle->buffer)) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(handle->buffer, p + 1, sizeof(handle->buffer));
+    sh1106_mark_dirty(handle, 0, 0, SH1106_WIDTH, SH1106_PAGES);
+    ret = ESP_OK;
+    break;
+  case SH1106_ANIM_FRAME_DELTA:
+    ret = anim_apply_delta(handle, p + 1, end);
+    break;
+  default:
+    ret = ESP_ERR_INVALID_SIZE;
+    break;
+  }
+
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Frame %u is corrupt", index);
+    return ret;
+  }
+
+  anim->next_frame++;
+  anim->stats.frames_decoded++;
+  return ESP_OK;
+}
+
+static uint32_t anim_dirty_bytes(const sh1106_handle_t *handle) {
+  uint32_t bytes = 0;
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    if (handle->dirty_end[page] > handle->dirty_start[page]) {
+      bytes += handle->dirty_end[page] - handle->dirty_start[page];
+    }
+  }
+  return bytes;
+}
+
+static void anim_wake_cb(void *arg) { xTaskNotifyGive((TaskHandle_t)arg); }
+
+// Sleep until an absolute esp_timer time; vTaskDelay() would round the wait
+// down to whole ticks and run every frame early
+static void anim_sleep_until(esp_timer_handle_t timer, int64_t deadline) {
+  int64_t now = esp_timer_get_time();
+  if (deadline > now &&
+      esp_timer_start_once(timer, (uint64_t)(deadline - now)) == ESP_OK) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+static esp_err_t anim_play_loop(sh1106_anim_t *anim, sh1106_handle_t *handle,
+                                uint32_t loops, esp_timer_handle_t timer) {
+  bool forever = (loops == 0) && (anim->flags & SH1106_ANIM_FLAG_LOOP);
+  if (loops == 0) {
+    loops = 1;
+  }
+
+  int64_t period_us = 1000000 / anim->fps;
+  int64_t deadline = esp_timer_get_time() + period_us;
+
+  for (uint32_t pass = 0; forever || pass < loops; pass++) {
+    sh1106_anim_rewind(anim);
+
+    while (anim->next_frame < anim->frame_count) {
+      esp_err_t ret = sh1106_anim_decode_next(anim, handle);
+      if (ret != ESP_OK) {
+        return ret;
+      }
+
+      int64_t now = esp_timer_get_time();
+      int64_t late = now - deadline;
+      if (late > (int64_t)anim->stats.max_late_us) {
+        anim->stats.max_late_us = (uint32_t)late;
+      }
+
+      // More than a frame behind: keep decoding, skip the bus until caught
+      // up. The last frame of a pass is always shown.
+      bool last = anim->next_frame == anim->frame_count;
+      if (late > period_us && !last) {
+        anim->stats.frames_dropped++;
+      } else {
+        anim->stats.bytes_sent += anim_dirty_bytes(handle);
+        ret = sh1106_update_dirty(handle);
+        if (ret != ESP_OK) {
+          return ret;
+        }
+        anim->stats.frames_shown++;
+        anim_sleep_until(timer, deadline);
+      }
+
+      deadline += period_us;
+    }
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_anim_play(sh1106_anim_t *anim, sh1106_handle_t *handle,
+                           uint32_t loops) {
+  if (anim->data == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // Wakes this task at each frame deadline
+  esp_timer_create_args_t timer_args = {
+      .callback = anim_wake_cb,
+      .arg = xTaskGetCurrentTaskHandle(),
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "sh1106_anim",
+  };
+  esp_timer_handle_t timer;
+  esp_err_t ret = esp_timer_create(&timer_args, &timer);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create frame timer");
+    return ret;
+  }
+
+  ret = anim_play_loop(anim, handle, loops, timer);
+  // Every started one-shot was waited for, so no callback is pending
+  esp_timer_delete(timer);
+  return ret;
+}
+
+void sh1106_anim_get_stats(const sh1106_anim_t *anim,
+                           sh1106_anim_stats_t *stats) {
+  *stats = anim->stats;
+}
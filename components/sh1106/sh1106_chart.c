@@ -0,0 +1,204 @@
+#include "sh1106_chart.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+// Sample @p age steps back from the newest (0 = newest)
+static const sh1106_chart_sample_t *chart_sample(const sh1106_chart_t *chart,
+                                                 uint8_t age) {
+  uint8_t index = (chart->head + SH1106_CHART_CAPACITY - 1 - age) %
+                  SH1106_CHART_CAPACITY;
+  return &chart->samples[index];
+}
+
+static uint8_t chart_visible(const sh1106_chart_t *chart) {
+  return chart->count < chart->width ? chart->count : chart->width;
+}
+
+// Chart row of a value, 0 at the top, clipped to the chart
+static uint8_t chart_row(const sh1106_chart_t *chart, int16_t value) {
+  int32_t bottom = chart->pages * 8 - 1;
+  int32_t span = (int32_t)chart->range_max - chart->range_min;
+
+  if (value <= chart->range_min) {
+    return bottom;
+  }
+  if (value >= chart->range_max) {
+    return 0;
+  }
+  int32_t offset = (int32_t)value - chart->range_min;
+  return bottom - (offset * bottom + span / 2) / span;
+}
+
+// Draw the column showing the sample @p age steps old. Costs one byte per
+// page, whatever the width of the chart.
+static void chart_draw_column(sh1106_chart_t *chart, uint8_t col,
+                              uint8_t age) {
+  int16_t top = 0;
+  int16_t bottom = -1; // Empty column
+
+  if (age < chart->count) {
+    const sh1106_chart_sample_t *s = chart_sample(chart, age);
+    top = chart_row(chart, s->max);
+
+    switch (chart->style) {
+    case SH1106_CHART_BARS:
+      bottom = chart->pages * 8 - 1;
+      break;
+    case SH1106_CHART_BAND:
+      bottom = chart_row(chart, s->min);
+      break;
+    default:
+      bottom = top;
+      // Join to the previous sample with a vertical run
+      if (age + 1 < chart->count) {
+        int16_t prev = chart_row(chart, chart_sample(chart, age + 1)->max);
+        if (prev < top) {
+          top = prev;
+        } else {
+          bottom = prev;
+        }
+      }
+      break;
+    }
+  }
+
+  for (uint8_t p = 0; p < chart->pages; p++) {
+    int16_t first = top - p * 8;
+    int16_t last = bottom - p * 8;
+    uint8_t bits = 0;
+
+    if (last >= 0 && first <= 7) {
+      first = first < 0 ? 0 : first;
+      last = last > 7 ? 7 : last;
+      bits = (uint8_t)((0xFFu << first) & (0xFFu >> (7 - last)));
+    }
+    sh1106_fb_row(chart->display, chart->page + p)[chart->x + col] = bits;
+  }
+}
+
+static void chart_mark_dirty(sh1106_chart_t *chart) {
+  sh1106_mark_dirty(chart->display, chart->x, chart->page, chart->width,
+                    chart->pages);
+}
+
+// Fit the autoscale range to the visible samples. Returns true if the
+// range changed and the chart needs a full redraw.
+static bool chart_fit_range(sh1106_chart_t *chart) {
+  uint8_t visible = chart_visible(chart);
+  if (!chart->autoscale || visible == 0) {
+    return false;
+  }
+
+  int16_t lo = INT16_MAX;
+  int16_t hi = INT16_MIN;
+  for (uint8_t age = 0; age < visible; age++) {
+    const sh1106_chart_sample_t *s = chart_sample(chart, age);
+    lo = s->min < lo ? s->min : lo;
+    hi = s->max > hi ? s->max : hi;
+  }
+
+  int32_t span = (int32_t)chart->range_max - chart->range_min;
+  if (lo >= chart->range_min && hi <= chart->range_max &&
+      ((int32_t)hi - lo) * 2 >= span) {
+    return false;
+  }
+
+  if (lo == hi) {
+    if (hi < INT16_MAX) {
+      hi++;
+    } else {
+      lo--;
+    }
+  }
+  chart->range_min = lo;
+  chart->range_max = hi;
+  return true;
+}
+
+esp_err_t sh1106_chart_init(sh1106_chart_t *chart, sh1106_handle_t *handle,
+                            sh1106_chart_style_t style, uint8_t x,
+                            uint8_t page, uint8_t width, uint8_t pages) {
+  if (chart == NULL || handle == NULL || style > SH1106_CHART_BAND ||
+      x >= handle->width || page >= handle->height / 8 || width == 0 ||
+      pages == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(chart, 0, sizeof(*chart));
+  chart->display = handle;
+  chart->style = style;
+  chart->x = x;
+  chart->width = (width > handle->width - x) ? handle->width - x : width;
+  chart->page = page;
+  chart->pages = (pages > handle->height / 8 - page)
+                     ? handle->height / 8 - page
+                     : pages;
+  chart->autoscale = true;
+  chart->range_min = 0;
+  chart->range_max = 1;
+
+  sh1106_chart_redraw(chart);
+  return ESP_OK;
+}
+
+void sh1106_chart_set_range(sh1106_chart_t *chart, int16_t min, int16_t max) {
+  if (max <= min) {
+    return;
+  }
+  chart->autoscale = false;
+  chart->range_min = min;
+  chart->range_max = max;
+  sh1106_chart_redraw(chart);
+}
+
+void sh1106_chart_set_autoscale(sh1106_chart_t *chart, bool enable) {
+  chart->autoscale = enable;
+  if (chart_fit_range(chart)) {
+    sh1106_chart_redraw(chart);
+  }
+}
+
+void sh1106_chart_add(sh1106_chart_t *chart, int16_t value) {
+  sh1106_chart_add_range(chart, value, value);
+}
+
+void sh1106_chart_add_range(sh1106_chart_t *chart, int16_t min, int16_t max) {
+  if (max < min) {
+    int16_t tmp = min;
+    min = max;
+    max = tmp;
+  }
+
+  chart->samples[chart->head].min = min;
+  chart->samples[chart->head].max = max;
+  chart->head = (chart->head + 1) % SH1106_CHART_CAPACITY;
+  if (chart->count < chart->width + 1) {
+    chart->count++;
+  }
+
+  if (chart_fit_range(chart)) {
+    sh1106_chart_redraw(chart);
+    return;
+  }
+
+  // Same scale: every drawn column moves one to the left
+  for (uint8_t p = 0; p < chart->pages; p++) {
+    uint8_t *row = sh1106_fb_row(chart->display, chart->page + p) + chart->x;
+    memmove(row, row + 1, chart->width - 1);
+  }
+  chart_draw_column(chart, chart->width - 1, 0);
+  chart_mark_dirty(chart);
+}
+
+void sh1106_chart_clear(sh1106_chart_t *chart) {
+  chart->head = 0;
+  chart->count = 0;
+  sh1106_chart_redraw(chart);
+}
+
+void sh1106_chart_redraw(sh1106_chart_t *chart) {
+  for (uint8_t col = 0; col < chart->width; col++) {
+    chart_draw_column(chart, col, chart->width - 1 - col);
+  }
+  chart_mark_dirty(chart);
+}
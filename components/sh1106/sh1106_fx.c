@@ -0,0 +1,306 @@
+#include "sh1106_fx.h"
+#include "esp_log.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+static const char *TAG = "SH1106_FX";
+
+#define FX_DEFAULT_FADE_STEPS 16
+#define FX_DEFAULT_SLIDE_STEPS 32
+#define FX_MIN_PERIOD_US 1000
+#define FX_RAM_ROWS 64
+
+static bool fx_is_fade(sh1106_fx_type_t type) {
+  return type == SH1106_FX_FADE_IN || type == SH1106_FX_FADE_OUT;
+}
+
+static bool fx_is_blink(sh1106_fx_type_t type) {
+  return type == SH1106_FX_BLINK || type == SH1106_FX_FLASH;
+}
+
+static void fx_send(sh1106_fx_t *fx, const uint8_t *cmds, size_t len) {
+  esp_err_t ret = sh1106_write_commands(fx->display, cmds, len);
+  if (ret != ESP_OK && fx->error == ESP_OK) {
+    fx->error = ret;
+  }
+}
+
+// True if the target enters from the top of RAM. The 180 degree rotation
+// flips the panel, so RAM top is the bottom of the glass there.
+static bool fx_from_top(const sh1106_fx_t *fx) {
+  bool top = fx->config.type != SH1106_FX_SLIDE_DOWN;
+  return fx->display->rotation == SH1106_ROTATION_180 ? !top : top;
+}
+
+// Rows of a page that show the target once @p line rows of it are in
+static uint8_t fx_page_mask(bool from_top, uint8_t page, uint8_t line) {
+  int16_t first = page * 8;
+  int16_t rows;
+
+  if (from_top) {
+    rows = line - first; // Target covers RAM rows [0, line)
+    rows = rows < 0 ? 0 : (rows > 8 ? 8 : rows);
+    return (uint8_t)((1u << rows) - 1);
+  }
+  rows = first + 8 - (SH1106_HEIGHT - line); // ... or [64 - line, 64)
+  rows = rows < 0 ? 0 : (rows > 8 ? 8 : rows);
+  return (uint8_t)(0xFF00u >> rows);
+}
+
+// Move the boundary between the two frames to @p line rows. Only the pages
+// the boundary crossed are rewritten; the slides then pan the picture with
+// the start line instead of resending it.
+static void fx_move_line(sh1106_fx_t *fx, uint8_t line) {
+  sh1106_handle_t *handle = fx->display;
+  bool from_top = fx_from_top(fx);
+  uint8_t lo, hi; // RAM rows [lo, hi) switch to the target
+
+  if (from_top) {
+    lo = fx->line;
+    hi = line;
+  } else {
+    lo = SH1106_HEIGHT - line;
+    hi = SH1106_HEIGHT - fx->line;
+  }
+
+  if (lo < hi) {
+    for (uint8_t page = lo / 8; page <= (hi - 1) / 8; page++) {
+      uint8_t mask = fx_page_mask(from_top, page, line);
+      const uint8_t *to = fx->config.to[page];
+      const uint8_t *from = handle->buffer[page];
+
+      for (uint8_t col = 0; col < SH1106_WIDTH; col++) {
+        fx->page_buf[col] = (to[col] & mask) | (from[col] & ~mask);
+      }
+      esp_err_t ret = sh1106_write_page(handle, page, 0, fx->page_buf,
+                                        SH1106_WIDTH);
+      // page_buf is reused for the next page
+      sh1106_wait_idle(handle);
+      if (ret != ESP_OK && fx->error == ESP_OK) {
+        fx->error = ret;
+      }
+    }
+  }
+
+  if (fx->config.type != SH1106_FX_WIPE_DOWN) {
+    uint8_t start = from_top ? line : SH1106_HEIGHT - line;
+    uint8_t cmd = SH1106_CMD_SET_START_LINE | (start & (SH1106_HEIGHT - 1));
+    fx_send(fx, &cmd, 1);
+  }
+  fx->line = line;
+}
+
+// Bring the panel to the state of step @p step (1..total)
+static void fx_apply(sh1106_fx_t *fx, uint16_t step) {
+  const sh1106_fx_config_t *cfg = &fx->config;
+  bool last = step >= fx->total;
+
+  switch (cfg->type) {
+  case SH1106_FX_FADE_IN: {
+    uint8_t cmds[2] = {SH1106_CMD_SET_CONTRAST,
+                       (uint8_t)((uint32_t)cfg->contrast * step / fx->total)};
+    fx_send(fx, cmds, sizeof(cmds));
+    break;
+  }
+  case SH1106_FX_FADE_OUT:
+    if (last) {
+      // Off, then restore the contrast for the next display on
+      uint8_t cmds[3] = {SH1106_CMD_DISPLAY_OFF, SH1106_CMD_SET_CONTRAST,
+                         cfg->contrast};
+      fx_send(fx, cmds, sizeof(cmds));
+    } else {
+      uint8_t cmds[2] = {SH1106_CMD_SET_CONTRAST,
+                         (uint8_t)((uint32_t)cfg->contrast *
+                                   (fx->total - step) / fx->total)};
+      fx_send(fx, cmds, sizeof(cmds));
+    }
+    break;
+  case SH1106_FX_BLINK:
+  case SH1106_FX_FLASH: {
+    // Odd steps show the effect; total is even, so it ends back to normal
+    bool on = (step & 1) != 0;
+    uint8_t cmd;
+    if (cfg->type == SH1106_FX_BLINK) {
+      cmd = on ? SH1106_CMD_INVERSE_DISPLAY : SH1106_CMD_NORMAL_DISPLAY;
+    } else {
+      cmd = on ? SH1106_CMD_ENTIRE_DISPLAY_ON : SH1106_CMD_ENTIRE_DISPLAY_RAM;
+    }
+    fx_send(fx, &cmd, 1);
+    break;
+  }
+  default:
+    fx_move_line(fx, (uint8_t)((uint32_t)SH1106_HEIGHT * step / fx->total));
+    if (last) {
+      // The target is now what the panel shows, with start line 0
+      sh1106_handle_t *handle = fx->display;
+      memcpy(handle->buffer, cfg->to, sizeof(handle->buffer));
+      memset(handle->dirty_start, SH1106_WIDTH, sizeof(handle->dirty_start));
+      memset(handle->dirty_end, 0, sizeof(handle->dirty_end));
+    }
+    break;
+  }
+}
+
+static void fx_task(void *arg) {
+  sh1106_fx_t *fx = (sh1106_fx_t *)arg;
+
+  while (fx->step < fx->total) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // Late ticks are not replayed: each wake-up is one step, so a slow
+    // bus stretches the effect instead of skipping frames
+    uint16_t step = fx->cancel ? fx->total : fx->step + 1;
+    fx_apply(fx, step);
+    fx->step = step;
+  }
+
+  // The timer callback deletes this task. Deleting itself here could race
+  // with a tick that is about to notify it.
+  fx->running = false;
+  vTaskSuspend(NULL);
+}
+
+static void fx_timer_cb(void *arg) {
+  sh1106_fx_t *fx = (sh1106_fx_t *)arg;
+
+  if (fx->running) {
+    xTaskNotifyGive(fx->task);
+    return;
+  }
+
+  // Last step done: this callback is the only notifier, so tear down here
+  esp_timer_stop(fx->timer);
+  vTaskDelete(fx->task);
+  xSemaphoreGive(fx->done);
+}
+
+esp_err_t sh1106_fx_start(sh1106_fx_t *fx, sh1106_handle_t *handle,
+                          const sh1106_fx_config_t *config) {
+  if (fx == NULL || handle == NULL || config == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (config->type > SH1106_FX_WIPE_DOWN ||
+      (fx_is_blink(config->type) && config->count == 0)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  bool slide = !fx_is_fade(config->type) && !fx_is_blink(config->type);
+  if (slide) {
+    if (config->to == NULL || config->to == handle->buffer) {
+      return ESP_ERR_INVALID_ARG;
+    }
+    if (sh1106_is_portrait(handle)) {
+      ESP_LOGE(TAG, "Slides and wipes need a landscape rotation");
+      return ESP_ERR_NOT_SUPPORTED;
+    }
+    // The start line wraps at 64 RAM rows, so shorter glass cannot pan
+    if (SH1106_HEIGHT != FX_RAM_ROWS) {
+      ESP_LOGE(TAG, "Slides and wipes need a 64-row panel");
+      return ESP_ERR_NOT_SUPPORTED;
+    }
+  }
+
+  memset(fx, 0, sizeof(*fx));
+  fx->display = handle;
+  fx->config = *config;
+  fx->error = ESP_OK;
+
+  if (fx_is_blink(config->type)) {
+    fx->total = (uint16_t)config->count * 2;
+  } else if (config->steps != 0) {
+    fx->total = config->steps;
+  } else {
+    fx->total = slide ? FX_DEFAULT_SLIDE_STEPS : FX_DEFAULT_FADE_STEPS;
+  }
+  // A slide cannot move less than one row per step
+  if (slide && fx->total > SH1106_HEIGHT) {
+    fx->total = SH1106_HEIGHT;
+  }
+
+  uint64_t period_us = (uint64_t)config->duration_ms * 1000 / fx->total;
+  if (period_us < FX_MIN_PERIOD_US) {
+    period_us = FX_MIN_PERIOD_US;
+  }
+
+  if (config->type == SH1106_FX_FADE_IN) {
+    uint8_t cmds[3] = {SH1106_CMD_SET_CONTRAST, 0, SH1106_CMD_DISPLAY_ON};
+    esp_err_t ret = sh1106_write_commands(handle, cmds, sizeof(cmds));
+    if (ret != ESP_OK) {
+      return ret;
+    }
+  }
+
+  fx->done = xSemaphoreCreateBinary();
+  if (fx->done == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_timer_create_args_t timer_args = {
+      .callback = fx_timer_cb,
+      .arg = fx,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "sh1106_fx",
+      .skip_unhandled_events = true,
+  };
+  esp_err_t ret = esp_timer_create(&timer_args, &fx->timer);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to create step timer");
+    vSemaphoreDelete(fx->done);
+    fx->done = NULL;
+    return ret;
+  }
+
+  fx->running = true;
+  if (xTaskCreate(fx_task, "sh1106_fx", 3072, fx, config->task_priority,
+                  &fx->task) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create step task");
+    fx->running = false;
+    esp_timer_delete(fx->timer);
+    vSemaphoreDelete(fx->done);
+    fx->done = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  ret = esp_timer_start_periodic(fx->timer, period_us);
+  if (ret != ESP_OK) {
+    // No tick has reached the task, so it can go at once. Apply the final
+    // state here so the panel is left consistent.
+    ESP_LOGE(TAG, "Failed to start step timer");
+    vTaskDelete(fx->task);
+    fx->running = false;
+    fx_apply(fx, fx->total);
+    fx->step = fx->total;
+    xSemaphoreGive(fx->done);
+    sh1106_fx_wait(fx, portMAX_DELAY);
+    return ret;
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_fx_wait(sh1106_fx_t *fx, TickType_t timeout) {
+  if (fx == NULL || fx->done == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (xSemaphoreTake(fx->done, timeout) != pdTRUE) {
+    return ESP_ERR_TIMEOUT;
+  }
+
+  esp_timer_delete(fx->timer);
+  fx->timer = NULL;
+  vSemaphoreDelete(fx->done);
+  fx->done = NULL;
+  fx->task = NULL;
+
+  return fx->error;
+}
+
+esp_err_t sh1106_fx_finish(sh1106_fx_t *fx) {
+  if (fx == NULL || fx->done == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // The next timer tick jumps straight to the last step
+  fx->cancel = true;
+  return sh1106_fx_wait(fx, portMAX_DELAY);
+}
@@ -0,0 +1,361 @@
+#include "sh1106_gray.h"
+#include "esp_log.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+static const char *TAG = "SH1106_GRAY";
+
+#define GRAY_PLANE_LSB 0
+#define GRAY_PLANE_MSB 1
+
+// Subframe sequences: which bitplane each subframe shows
+static const uint8_t gray_seq_pwm[] = {GRAY_PLANE_MSB, GRAY_PLANE_MSB,
+                                       GRAY_PLANE_LSB};
+static const uint8_t gray_seq_contrast[] = {GRAY_PLANE_MSB, GRAY_PLANE_LSB};
+
+// Gather the even bits of each 16-bit half into its low byte. One 32-bit word
+// carries two columns, so a page of 128 columns is 64 iterations.
+static inline uint32_t gray_compress_even(uint32_t x) {
+  x &= 0x55555555u;
+  x = (x | (x >> 1)) & 0x33333333u;
+  x = (x | (x >> 2)) & 0x0F0F0F0Fu;
+  x = (x | (x >> 4)) & 0x00FF00FFu;
+  return x;
+}
+
+// Inverse of gray_compress_even: spread the low byte of each 16-bit half
+// onto the even bit positions
+static inline uint32_t gray_spread_even(uint32_t x) {
+  x &= 0x00FF00FFu;
+  x = (x | (x << 4)) & 0x0F0F0F0Fu;
+  x = (x | (x << 2)) & 0x33333333u;
+  x = (x | (x << 1)) & 0x55555555u;
+  return x;
+}
+
+static void gray_extract_plane(const uint16_t *src, uint8_t *dst,
+                               uint8_t plane) {
+  for (uint8_t col = 0; col < SH1106_WIDTH; col += 4) {
+    uint32_t w0, w1;
+    memcpy(&w0, &src[col], sizeof(w0));
+    memcpy(&w1, &src[col + 2], sizeof(w1));
+    w0 = gray_compress_even(w0 >> plane);
+    w1 = gray_compress_even(w1 >> plane);
+    dst[col] = (uint8_t)w0;
+    dst[col + 1] = (uint8_t)(w0 >> 16);
+    dst[col + 2] = (uint8_t)w1;
+    dst[col + 3] = (uint8_t)(w1 >> 16);
+  }
+}
+
+static void gray_flush_subframe(sh1106_gray_t *gray) {
+  const uint8_t *seq;
+  uint8_t seq_len;
+
+  if (gray->config.mode == SH1106_GRAY_MODE_CONTRAST) {
+    seq = gray_seq_contrast;
+    seq_len = sizeof(gray_seq_contrast);
+  } else {
+    seq = gray_seq_pwm;
+    seq_len = sizeof(gray_seq_pwm);
+  }
+
+  uint8_t plane = seq[gray->phase];
+  gray->phase = (gray->phase + 1) % seq_len;
+  gray->stats.subframes++;
+
+  uint32_t generation = gray->generation;
+  uint8_t contrast = gray->config.contrast_high;
+  if (gray->config.mode == SH1106_GRAY_MODE_CONTRAST &&
+      plane == GRAY_PLANE_LSB) {
+    contrast = gray->config.contrast_low;
+  }
+
+  // Nothing to send if the panel already shows this plane unchanged
+  if (plane == gray->shown_plane && generation == gray->shown_generation &&
+      contrast == gray->shown_contrast) {
+    return;
+  }
+
+  int64_t start = esp_timer_get_time();
+
+  if (contrast != gray->shown_contrast) {
+    sh1106_set_contrast(gray->display, contrast);
+    gray->shown_contrast = contrast;
+  }
+
+  if (plane != gray->shown_plane || generation != gray->shown_generation) {
+    // The whole plane goes out before the single wait, so queued transports
+    // keep the bus busy; the last subframe's transfers are done by now
+    for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+      gray_extract_plane(gray->pixels[page], gray->plane[page], plane);
+    }
+    sh1106_write_pages(gray->display, 0, SH1106_PAGES, &gray->plane[0][0]);
+    sh1106_wait_idle(gray->display);
+    gray->shown_plane = plane;
+    gray->shown_generation = generation;
+  }
+
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+  gray->flush_total_us += elapsed;
+  gray->stats.flushed++;
+  if (elapsed < gray->stats.min_flush_us) {
+    gray->stats.min_flush_us = elapsed;
+  }
+  if (elapsed > gray->stats.max_flush_us) {
+    gray->stats.max_flush_us = elapsed;
+  }
+}
+
+static void gray_task(void *arg) {
+  sh1106_gray_t *gray = (sh1106_gray_t *)arg;
+
+  while (1) {
+    uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (gray->stopping) {
+      break;
+    }
+
+    // More than one pending tick means the previous flush overran
+    if (ticks > 1) {
+      gray->stats.late_subframes += ticks - 1;
+    }
+
+    gray_flush_subframe(gray);
+  }
+
+  // The timer callback deletes this task. Deleting itself here could race
+  // with a tick that is about to notify it.
+  gray->running = false;
+  vTaskSuspend(NULL);
+}
+
+static void gray_timer_cb(void *arg) {
+  sh1106_gray_t *gray = (sh1106_gray_t *)arg;
+
+  if (gray->running) {
+    xTaskNotifyGive(gray->task);
+    return;
+  }
+
+  // The task has parked: this callback is the only notifier, so tear down
+  // here
+  esp_timer_stop(gray->timer);
+  vTaskDelete(gray->task);
+  xSemaphoreGive(gray->done);
+}
+
+static void gray_reset_stats(sh1106_gray_t *gray) {
+  memset(&gray->stats, 0, sizeof(gray->stats));
+  gray->stats.min_flush_us = UINT32_MAX;
+  gray->stats.target_hz = gray->config.subframe_hz;
+  gray->flush_total_us = 0;
+  gray->stats_start_us = esp_timer_get_time();
+}
+
+esp_err_t sh1106_gray_init(sh1106_gray_t *gray, sh1106_handle_t *display,
+                           const sh1106_gray_config_t *config) {
+  if (gray == NULL || display == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(gray, 0, sizeof(*gray));
+  gray->display = display;
+
+  if (config != NULL) {
+    gray->config = *config;
+  } else {
+    gray->config = (sh1106_gray_config_t)SH1106_GRAY_CONFIG_DEFAULT();
+  }
+
+  if (gray->config.subframe_hz == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  gray->shown_plane = -1;
+  gray_reset_stats(gray);
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_gray_start(sh1106_gray_t *gray) {
+  if (gray->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  // Bitplanes are sent in the native page layout
+  if (sh1106_is_portrait(gray->display)) {
+    ESP_LOGE(TAG, "Grayscale needs a landscape rotation");
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  gray->done = xSemaphoreCreateBinary();
+  if (gray->done == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  gray->phase = 0;
+  gray->shown_plane = -1;
+  gray->shown_contrast = 0;
+  gray->stopping = false;
+  gray->running = true;
+
+  if (xTaskCreatePinnedToCore(gray_task, "sh1106_gray", 3072, gray,
+                              gray->config.task_priority, &gray->task,
+                              gray->config.core_id) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to create flush task");
+    gray->running = false;
+    vSemaphoreDelete(gray->done);
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_timer_create_args_t timer_args = {
+      .callback = gray_timer_cb,
+      .arg = gray,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "sh1106_gray",
+      .skip_unhandled_events = true,
+  };
+
+  esp_err_t ret = esp_timer_create(&timer_args, &gray->timer);
+  if (ret == ESP_OK) {
+    gray_reset_stats(gray);
+    ret = esp_timer_start_periodic(gray->timer,
+                                   1000000ULL / gray->config.subframe_hz);
+  }
+
+  if (ret != ESP_OK) {
+    // No tick has reached the task, so it can go at once
+    ESP_LOGE(TAG, "Failed to start subframe timer");
+    vTaskDelete(gray->task);
+    gray->task = NULL;
+    if (gray->timer != NULL) {
+      esp_timer_delete(gray->timer);
+      gray->timer = NULL;
+    }
+    gray->running = false;
+    vSemaphoreDelete(gray->done);
+    return ret;
+  }
+
+  ESP_LOGI(TAG, "Grayscale started at %u Hz", gray->config.subframe_hz);
+  return ESP_OK;
+}
+
+esp_err_t sh1106_gray_stop(sh1106_gray_t *gray) {
+  if (!gray->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // The task parks at the next tick and the tick after that tears it down,
+  // as sh1106_fx does
+  gray->stopping = true;
+  xSemaphoreTake(gray->done, portMAX_DELAY);
+  esp_timer_delete(gray->timer);
+  gray->timer = NULL;
+  vSemaphoreDelete(gray->done);
+  gray->task = NULL;
+
+  return sh1106_set_contrast(gray->display, gray->config.contrast_high);
+}
+
+void sh1106_gray_clear(sh1106_gray_t *gray) {
+  memset(gray->pixels, 0, sizeof(gray->pixels));
+  gray->generation++;
+}
+
+void sh1106_gray_set_pixel(sh1106_gray_t *gray, uint8_t x, uint8_t y,
+                           uint8_t level) {
+  if (x >= SH1106_WIDTH || y >= SH1106_HEIGHT) {
+    return;
+  }
+
+  uint8_t shift = (y & 7) * 2;
+  uint16_t *word = &gray->pixels[y >> 3][x];
+  *word = (*word & ~(0x3 << shift)) | ((level & 0x3) << shift);
+  gray->generation++;
+}
+
+void sh1106_gray_fill_rect(sh1106_gray_t *gray, uint8_t x, uint8_t y,
+                           uint8_t w, uint8_t h, uint8_t level) {
+  if (x >= SH1106_WIDTH || y >= SH1106_HEIGHT || w == 0 || h == 0) {
+    return;
+  }
+  if (w > SH1106_WIDTH - x) {
+    w = SH1106_WIDTH - x;
+  }
+  if (h > SH1106_HEIGHT - y) {
+    h = SH1106_HEIGHT - y;
+  }
+
+  // Replicate the 2-bit level across all 8 rows of a column word
+  uint16_t pattern = (level & 0x3) * 0x5555;
+  uint16_t y_end = y + h;
+
+  for (uint8_t page = y >> 3; page <= (y_end - 1) >> 3; page++) {
+    uint8_t row_start = (page == (y >> 3)) ? (y & 7) : 0;
+    uint8_t row_end = (page == ((y_end - 1) >> 3)) ? ((y_end - 1) & 7) : 7;
+
+    // Two bits per row covered by this page
+    uint16_t mask = (uint16_t)(((1u << ((row_end + 1) * 2)) - 1) &
+                               ~((1u << (row_start * 2)) - 1));
+
+    for (uint8_t col = x; col < x + w; col++) {
+      uint16_t *word = &gray->pixels[page][col];
+      *word = (*word & ~mask) | (pattern & mask);
+    }
+  }
+
+  gray->generation++;
+}
+
+esp_err_t sh1106_gray_import_buffer(sh1106_gray_t *gray, uint8_t level) {
+  // A portrait buffer is not laid out like the 2bpp surface
+  if (sh1106_is_portrait(gray->display)) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  uint32_t lsb = (level & 0x1) ? 0xFFFFFFFFu : 0;
+  uint32_t msb = (level & 0x2) ? 0xFFFFFFFFu : 0;
+
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    const uint8_t *mono = gray->display->buffer[page];
+    uint16_t *dst = gray->pixels[page];
+
+    for (uint8_t col = 0; col < SH1106_WIDTH; col += 2) {
+      // Two columns per word: expand each mono byte to a 2-bit-per-row mask
+      uint32_t set = gray_spread_even(mono[col] | ((uint32_t)mono[col + 1]
+                                                   << 16));
+      uint32_t mask = set | (set << 1);
+      uint32_t value = (set & lsb) | ((set << 1) & msb);
+
+      uint32_t w;
+      memcpy(&w, &dst[col], sizeof(w));
+      w = (w & ~mask) | value;
+      memcpy(&dst[col], &w, sizeof(w));
+    }
+  }
+
+  gray->generation++;
+  return ESP_OK;
+}
+
+void sh1106_gray_get_stats(sh1106_gray_t *gray, sh1106_gray_stats_t *stats,
+                           bool reset) {
+  *stats = gray->stats;
+
+  if (stats->flushed > 0) {
+    stats->avg_flush_us = (uint32_t)(gray->flush_total_us / stats->flushed);
+  } else {
+    stats->min_flush_us = 0;
+  }
+
+  int64_t window_us = esp_timer_get_time() - gray->stats_start_us;
+  if (window_us > 0) {
+    stats->achieved_hz =
+        (uint32_t)(((uint64_t)stats->subframes * 1000000ULL) / window_us);
+  }
+
+  if (reset) {
+    gray_reset_stats(gray);
+  }
+}
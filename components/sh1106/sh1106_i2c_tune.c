@@ -0,0 +1,213 @@
+#include "sh1106.h"
+
+#if SH1106_BUS_DRIVERS
+
+#include "driver/i2c.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "sh1106_priv.h"
+#include "sh1106_strip.h"
+#include <string.h>
+
+static const char *TAG = "SH1106_I2C";
+
+#define TUNE_PROBE_LEN 2
+
+// Probe the RAM columns past the glass where there are any (130-131 on a
+// 128-column SH1106) so the pattern never shows up. Otherwise use the last
+// visible columns; the full frame sent after tuning repaints them.
+#if SH1106_RAM_COLUMNS - SH1106_COLUMN_OFFSET - SH1106_WIDTH >= TUNE_PROBE_LEN
+#define TUNE_PROBE_COL SH1106_WIDTH // Visible-column numbering
+#else
+#define TUNE_PROBE_COL (SH1106_WIDTH - TUNE_PROBE_LEN)
+#endif
+
+esp_err_t sh1106_i2c_set_clock(sh1106_handle_t *handle, uint32_t hz) {
+  i2c_config_t conf = {
+      .mode = I2C_MODE_MASTER,
+      .sda_io_num = handle->i2c_sda_pin,
+      .scl_io_num = handle->i2c_scl_pin,
+      .sda_pullup_en = GPIO_PULLUP_ENABLE,
+      .scl_pullup_en = GPIO_PULLUP_ENABLE,
+      .master.clk_speed = hz,
+  };
+
+  esp_err_t ret = i2c_param_config(handle->i2c_port, &conf);
+  if (ret == ESP_OK) {
+    handle->i2c_clk_hz = hz;
+  }
+  return ret;
+}
+
+void sh1106_i2c_account(sh1106_handle_t *handle, esp_err_t ret) {
+  if (ret != ESP_OK) {
+    handle->i2c_errors++;
+  }
+  if (!handle->i2c_fallback) {
+    return;
+  }
+
+  const sh1106_i2c_tune_config_t *tune = &handle->i2c_tune;
+  handle->i2c_window_xfers++;
+  if (ret != ESP_OK) {
+    handle->i2c_window_errors++;
+  }
+
+  if (handle->i2c_window_errors >= tune->error_threshold &&
+      handle->i2c_clk_hz > tune->min_hz) {
+    uint32_t hz = handle->i2c_clk_hz - tune->step_hz;
+    if (hz < tune->min_hz || hz > handle->i2c_clk_hz) {
+      hz = tune->min_hz;
+    }
+    ESP_LOGW(TAG, "%u errors in %u transfers, dropping clock to %lu Hz",
+             handle->i2c_window_errors, handle->i2c_window_xfers,
+             (unsigned long)hz);
+    sh1106_i2c_set_clock(handle, hz);
+    handle->i2c_window_xfers = 0;
+    handle->i2c_window_errors = 0;
+  } else if (handle->i2c_window_xfers >= tune->error_window) {
+    handle->i2c_window_xfers = 0;
+    handle->i2c_window_errors = 0;
+  }
+}
+
+// Read display RAM at the probe columns of a page. The first byte after a
+// column address is a dummy read on the SH1106.
+static esp_err_t tune_read_probe(sh1106_handle_t *handle, uint8_t page,
+                                 uint8_t *out) {
+  uint8_t ram_col = TUNE_PROBE_COL + SH1106_COLUMN_OFFSET;
+  uint8_t ctrl_cmds[] = {
+      0x80, SH1106_CMD_SET_PAGE_ADDR | page,
+      0x80, SH1106_CMD_SET_LOW_COLUMN | (ram_col & 0x0F),
+      0x80, SH1106_CMD_SET_HIGH_COLUMN | (ram_col >> 4),
+      0x40, // Following reads return display data
+  };
+  uint8_t data[TUNE_PROBE_LEN + 1];
+
+  uint8_t link_buf[I2C_LINK_RECOMMENDED_SIZE(3)];
+  i2c_cmd_handle_t i2c_cmd =
+      i2c_cmd_link_create_static(link_buf, sizeof(link_buf));
+  i2c_master_start(i2c_cmd);
+  i2c_master_write_byte(i2c_cmd, (handle->i2c_address << 1) | I2C_MASTER_WRITE,
+                        true);
+  i2c_master_write(i2c_cmd, ctrl_cmds, sizeof(ctrl_cmds), true);
+  i2c_master_start(i2c_cmd);
+  i2c_master_write_byte(i2c_cmd, (handle->i2c_address << 1) | I2C_MASTER_READ,
+                        true);
+  i2c_master_read(i2c_cmd, data, sizeof(data), I2C_MASTER_LAST_NACK);
+  i2c_master_stop(i2c_cmd);
+
+  esp_err_t ret = i2c_master_cmd_begin(handle->i2c_port, i2c_cmd,
+                                       pdMS_TO_TICKS(SH1106_I2C_TIMEOUT_MS));
+  i2c_cmd_link_delete_static(i2c_cmd);
+
+  memcpy(out, &data[1], TUNE_PROBE_LEN);
+  return ret;
+}
+
+// Write and (optionally) read back a pattern a number of times at the
+// current clock. Any NACK, timeout or mismatch fails the step.
+static bool tune_verify(sh1106_handle_t *handle, uint8_t rounds,
+                        bool readback) {
+  for (uint8_t i = 0; i < rounds; i++) {
+    uint8_t page = i % SH1106_PAGES;
+    uint8_t pattern[TUNE_PROBE_LEN] = {(uint8_t)(0xA5 ^ (i * 37)),
+                                       (uint8_t)(0x5A + i * 11)};
+    uint8_t got[TUNE_PROBE_LEN];
+
+    if (sh1106_write_page(handle, page, TUNE_PROBE_COL, pattern,
+                          sizeof(pattern)) != ESP_OK) {
+      return false;
+    }
+    if (!readback) {
+      continue;
+    }
+    if (tune_read_probe(handle, page, got) != ESP_OK ||
+        memcmp(got, pattern, sizeof(pattern)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+esp_err_t sh1106_i2c_autotune(sh1106_handle_t *handle,
+                              const sh1106_i2c_tune_config_t *config) {
+  if (handle == NULL || handle->i2c_clk_hz == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sh1106_i2c_tune_config_t tune = SH1106_I2C_TUNE_CONFIG_DEFAULT();
+  if (config != NULL) {
+    tune = *config;
+  }
+  if (tune.step_hz == 0 || tune.min_hz == 0 || tune.max_hz < tune.min_hz ||
+      tune.verify_rounds == 0 || tune.error_window == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint32_t original_hz = handle->i2c_clk_hz;
+  handle->i2c_fallback = false;
+
+  // Some modules leave the SH1106 read path unconnected; fall back to
+  // ACK-only checks if reads never match even at the slowest clock. The
+  // SSD1306 cannot be read over I2C at all.
+  esp_err_t ret = sh1106_i2c_set_clock(handle, tune.min_hz);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  bool readback = !SH1106_CONTROLLER_SSD1306 &&
+                  tune_verify(handle, tune.verify_rounds, true);
+  if (!readback && !SH1106_CONTROLLER_SSD1306) {
+    ESP_LOGW(TAG, "RAM read-back failed at %lu Hz, verifying by ACK only",
+             (unsigned long)tune.min_hz);
+  }
+
+  uint32_t best = 0;
+  for (uint32_t hz = tune.min_hz; hz <= tune.max_hz; hz += tune.step_hz) {
+    if (sh1106_i2c_set_clock(handle, hz) != ESP_OK ||
+        !tune_verify(handle, tune.verify_rounds, readback)) {
+      ESP_LOGI(TAG, "%lu Hz failed verification", (unsigned long)hz);
+      break;
+    }
+    best = hz;
+  }
+
+  if (best == 0) {
+    ESP_LOGE(TAG, "No reliable I2C clock found, keeping %lu Hz",
+             (unsigned long)original_hz);
+    sh1106_i2c_set_clock(handle, original_hz);
+    return ESP_FAIL;
+  }
+
+  uint32_t margin = (uint32_t)tune.margin_steps * tune.step_hz;
+  uint32_t chosen = (best - tune.min_hz > margin) ? best - margin : tune.min_hz;
+  ret = sh1106_i2c_set_clock(handle, chosen);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  // Failures while probing were expected; count from here on
+  handle->i2c_tune = tune;
+  handle->i2c_window_xfers = 0;
+  handle->i2c_window_errors = 0;
+  handle->i2c_errors = 0;
+  handle->i2c_fallback = true;
+
+  // Time one full frame at the chosen clock
+#if CONFIG_SH1106_FRAMEBUFFER
+  ret = sh1106_update_display(handle);
+#else
+  ret = sh1106_render_strips(handle, NULL, NULL);
+#endif
+
+  ESP_LOGI(TAG, "I2C clock %lu Hz (fastest passing %lu Hz), frame %lu us",
+           (unsigned long)chosen, (unsigned long)best,
+           (unsigned long)handle->frame_us);
+  return ret;
+}
+
+uint32_t sh1106_get_i2c_clock(const sh1106_handle_t *handle) {
+  return handle->i2c_clk_hz;
+}
+
+#endif // SH1106_BUS_DRIVERS
@@ -0,0 +1,302 @@
+#include "sh1106_image.h"
+#include "esp_log.h"
+#include "sh1106_priv.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "SH1106_IMAGE";
+
+// Ordered dither matrix (values 0-63)
+static const uint8_t bayer_8x8[8][8] = {
+    {0, 32, 8, 40, 2, 34, 10, 42},  {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44, 4, 36, 14, 46, 6, 38}, {60, 28, 52, 20, 62, 30, 54, 22},
+    {3, 35, 11, 43, 1, 33, 9, 41},  {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47, 7, 39, 13, 45, 5, 37}, {63, 31, 55, 23, 61, 29, 53, 21},
+};
+
+static uint16_t image_src_start(const sh1106_image_t *img, uint16_t d) {
+  return (uint32_t)d * img->cfg.src_height / img->cfg.dst_height;
+}
+
+static uint16_t image_src_end(const sh1106_image_t *img, uint16_t d) {
+  uint16_t start = image_src_start(img, d);
+  uint16_t end =
+      (uint32_t)(d + 1) * img->cfg.src_height / img->cfg.dst_height;
+  return end > start ? end : start + 1;
+}
+
+static void image_resample_row(sh1106_image_t *img, const uint8_t *src) {
+  uint8_t w = img->cfg.dst_width;
+  uint16_t src_w = img->cfg.src_width;
+
+  switch (img->cfg.scale) {
+  case SH1106_SCALE_NEAREST: {
+    // 16.16 fixed-point source position
+    uint32_t step = ((uint32_t)src_w << 16) / w;
+    uint32_t pos = 0;
+    for (uint8_t x = 0; x < w; x++) {
+      img->row[x] = src[pos >> 16];
+      pos += step;
+    }
+    break;
+  }
+  case SH1106_SCALE_BOX:
+    for (uint8_t x = 0; x < w; x++) {
+      uint16_t x0 = (uint32_t)x * src_w / w;
+      uint16_t x1 = (uint32_t)(x + 1) * src_w / w;
+      if (x1 <= x0) {
+        x1 = x0 + 1; // Upscaling: one source pixel per output
+      }
+      uint32_t sum = 0;
+      for (uint16_t i = x0; i < x1; i++) {
+        sum += src[i];
+      }
+      img->row[x] = sum / (x1 - x0);
+    }
+    break;
+  default:
+    memcpy(img->row, src, w);
+    break;
+  }
+
+  if (img->cfg.invert) {
+    for (uint8_t x = 0; x < w; x++) {
+      img->row[x] = 255 - img->row[x];
+    }
+  }
+}
+
+// Compare four pixels per 32-bit word against per-column thresholds. Pixels
+// are split into even/odd bytes in 16-bit lanes so the subtraction cannot
+// borrow across lanes; bit 8 of each lane is then the "lit" result.
+static void image_quantize_ordered(sh1106_image_t *img, uint8_t bit,
+                                   const uint16_t thr[8]) {
+  const uint32_t t_even[2] = {thr[0] | ((uint32_t)thr[2] << 16),
+                              thr[4] | ((uint32_t)thr[6] << 16)};
+  const uint32_t t_odd[2] = {thr[1] | ((uint32_t)thr[3] << 16),
+                             thr[5] | ((uint32_t)thr[7] << 16)};
+
+  // row[] is SH1106_WIDTH long, so whole words never run past it
+  for (uint8_t x = 0; x < img->cfg.dst_width; x += 4) {
+    uint32_t v;
+    memcpy(&v, &img->row[x], sizeof(v));
+
+    uint8_t half = (x >> 2) & 1;
+    uint32_t even = ((v & 0x00FF00FFu) | 0x01000100u) - t_even[half];
+    uint32_t odd = (((v >> 8) & 0x00FF00FFu) | 0x01000100u) - t_odd[half];
+
+    img->band[x] |= ((even >> 8) & 1) << bit;
+    img->band[x + 1] |= ((odd >> 8) & 1) << bit;
+    img->band[x + 2] |= ((even >> 24) & 1) << bit;
+    img->band[x + 3] |= ((odd >> 24) & 1) << bit;
+  }
+}
+
+// Single error row: the 3/16 and 5/16 terms for the row below are carried in
+// two accumulators and written back one column behind the read position.
+static void image_quantize_fs(sh1106_image_t *img, uint8_t bit) {
+  int16_t right = 0;
+  int16_t below = 0;      // Next-row error for x-1, sixteenths
+  int16_t below_next = 0; // Next-row error for x, sixteenths
+
+  for (uint8_t x = 0; x < img->cfg.dst_width; x++) {
+    int16_t v = img->row[x] + img->err[x] + right;
+    int16_t e = v;
+    if (v > 127) {
+      img->band[x] |= 1 << bit;
+      e = v - 255;
+    }
+
+    right = (e * 7) / 16;
+    below += e * 3;
+    if (x > 0) {
+      img->err[x - 1] = below / 16;
+    }
+    below = below_next + e * 5;
+    below_next = e;
+  }
+
+  img->err[img->cfg.dst_width - 1] = below / 16;
+}
+
+static void image_write_band(sh1106_image_t *img, uint8_t page) {
+  uint8_t mask = img->band_mask;
+  uint8_t *dst = &img->display->buffer[page][img->cfg.dst_x];
+
+  for (uint8_t x = 0; x < img->cfg.dst_width; x++) {
+    dst[x] = (dst[x] & ~mask) | (img->band[x] & mask);
+  }
+
+  sh1106_mark_dirty(img->display, img->cfg.dst_x, page, img->cfg.dst_width,
+                    1);
+
+  memset(img->band, 0, sizeof(img->band));
+  img->band_mask = 0;
+}
+
+static void image_emit_row(sh1106_image_t *img) {
+  uint8_t y = img->cfg.dst_y + img->dst_row;
+  uint8_t bit = y & 7;
+
+  switch (img->cfg.dither) {
+  case SH1106_DITHER_BAYER: {
+    uint16_t thr[8];
+    for (uint8_t i = 0; i < 8; i++) {
+      // Lit when value > 4 * b + 2, i.e. value >= 4 * b + 3
+      thr[i] = bayer_8x8[img->dst_row & 7][i] * 4 + 3;
+    }
+    image_quantize_ordered(img, bit, thr);
+    break;
+  }
+  case SH1106_DITHER_FLOYD_STEINBERG:
+    image_quantize_fs(img, bit);
+    break;
+  default: {
+    uint16_t thr[8];
+    for (uint8_t i = 0; i < 8; i++) {
+      thr[i] = img->cfg.threshold + 1;
+    }
+    image_quantize_ordered(img, bit, thr);
+    break;
+  }
+  }
+
+  img->band_mask |= 1 << bit;
+  img->dst_row++;
+
+  if (bit == 7 || img->dst_row == img->cfg.dst_height) {
+    image_write_band(img, y >> 3);
+  }
+}
+
+esp_err_t sh1106_image_begin(sh1106_image_t *img, sh1106_handle_t *handle,
+                             const sh1106_image_config_t *config) {
+  if (img == NULL || handle == NULL || config == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (config->src_width == 0 || config->src_height == 0 ||
+      config->dst_x >= SH1106_WIDTH || config->dst_y >= SH1106_HEIGHT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (sh1106_is_portrait(handle)) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  memset(img, 0, sizeof(*img));
+  img->display = handle;
+  img->cfg = *config;
+
+  uint16_t max_w = SH1106_WIDTH - config->dst_x;
+  uint16_t max_h = SH1106_HEIGHT - config->dst_y;
+  uint16_t w = config->dst_width ? config->dst_width : max_w;
+  uint16_t h = config->dst_height ? config->dst_height : max_h;
+
+  if (config->scale == SH1106_SCALE_NONE) {
+    // No scaling: destination is the source clipped to the display
+    if (w > config->src_width) {
+      w = config->src_width;
+    }
+    if (h > config->src_height) {
+      h = config->src_height;
+    }
+  }
+
+  img->cfg.dst_width = w < max_w ? w : max_w;
+  img->cfg.dst_height = h < max_h ? h : max_h;
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_image_push_row(sh1106_image_t *img, const uint8_t *row) {
+  if (row == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (img->src_row >= img->cfg.src_height) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  uint16_t i = img->src_row++;
+  if (img->dst_row >= img->cfg.dst_height) {
+    return ESP_OK; // Clipped
+  }
+
+  switch (img->cfg.scale) {
+  case SH1106_SCALE_NEAREST:
+    if (image_src_start(img, img->dst_row) != i) {
+      break;
+    }
+    image_resample_row(img, row);
+    // Upscaling emits the same source row several times
+    while (img->dst_row < img->cfg.dst_height &&
+           image_src_start(img, img->dst_row) == i) {
+      image_emit_row(img);
+    }
+    break;
+
+  case SH1106_SCALE_BOX:
+    image_resample_row(img, row);
+    for (uint8_t x = 0; x < img->cfg.dst_width; x++) {
+      img->accum[x] += img->row[x];
+    }
+    img->accum_rows++;
+
+    if (image_src_end(img, img->dst_row) != i + 1) {
+      break;
+    }
+    for (uint8_t x = 0; x < img->cfg.dst_width; x++) {
+      img->row[x] = img->accum[x] / img->accum_rows;
+    }
+    while (img->dst_row < img->cfg.dst_height &&
+           image_src_end(img, img->dst_row) == i + 1) {
+      image_emit_row(img);
+    }
+    memset(img->accum, 0, sizeof(img->accum));
+    img->accum_rows = 0;
+    break;
+
+  default:
+    image_resample_row(img, row);
+    image_emit_row(img);
+    break;
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_image_end(sh1106_image_t *img) {
+  if (img->band_mask != 0) {
+    uint8_t last_y = img->cfg.dst_y + img->dst_row - 1;
+    image_write_band(img, last_y >> 3);
+  }
+
+  if (img->src_row < img->cfg.src_height) {
+    ESP_LOGW(TAG, "Image ended after %u of %u rows", img->src_row,
+             img->cfg.src_height);
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_image_draw(sh1106_handle_t *handle,
+                            const sh1106_image_config_t *config,
+                            const uint8_t *pixels, size_t stride) {
+  if (pixels == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sh1106_image_t *img = malloc(sizeof(sh1106_image_t));
+  if (img == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_err_t ret = sh1106_image_begin(img, handle, config);
+  for (uint16_t y = 0; ret == ESP_OK && y < config->src_height; y++) {
+    ret = sh1106_image_push_row(img, pixels + (size_t)y * stride);
+  }
+  if (ret == ESP_OK) {
+    ret = sh1106_image_end(img);
+  }
+
+  free(img);
+  return ret;
+}
@@ -0,0 +1,357 @@
+#include "sh1106_layer.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+// ============================================================================
+// Compositor
+// ============================================================================
+
+// Add a screen rectangle to the damage, clipped to the display
+static void comp_damage(sh1106_compositor_t *comp, int x, int y, int w,
+                        int h) {
+  int x0 = x > 0 ? x : 0;
+  int y0 = y > 0 ? y : 0;
+  int x1 = (x + w < SH1106_WIDTH) ? x + w : SH1106_WIDTH;
+  int y1 = (y + h < SH1106_HEIGHT) ? y + h : SH1106_HEIGHT;
+
+  if (x0 >= x1 || y0 >= y1) {
+    return;
+  }
+
+  for (int page = y0 >> 3; page <= (y1 - 1) >> 3; page++) {
+    if (x0 < comp->damage_start[page]) {
+      comp->damage_start[page] = x0;
+    }
+    if (x1 > comp->damage_end[page]) {
+      comp->damage_end[page] = x1;
+    }
+  }
+}
+
+// Turn what changed on each layer since the last composite into damage
+static void comp_collect_damage(sh1106_compositor_t *comp) {
+  for (sh1106_layer_t *l = comp->bottom; l != NULL; l = l->next) {
+    bool moved = l->x != l->shown_x || l->y != l->shown_y;
+
+    if (l->shown_visible && (moved || !l->visible)) {
+      comp_damage(comp, l->shown_x, l->shown_y, l->width, l->height);
+    }
+    if (l->visible) {
+      if (moved || !l->shown_visible) {
+        comp_damage(comp, l->x, l->y, l->width, l->height);
+      } else if (l->dirty_x0 < l->dirty_x1) {
+        comp_damage(comp, l->x + l->dirty_x0, l->y + l->dirty_y0,
+                    l->dirty_x1 - l->dirty_x0, l->dirty_y1 - l->dirty_y0);
+      }
+    }
+
+    l->shown_x = l->x;
+    l->shown_y = l->y;
+    l->shown_visible = l->visible;
+    l->dirty_x0 = l->dirty_x1 = 0;
+    l->dirty_y0 = l->dirty_y1 = 0;
+  }
+}
+
+// Blend one layer into columns [start, end) of a framebuffer page
+static void comp_blend_page(const sh1106_layer_t *l, uint8_t page,
+                            uint8_t start, uint8_t end, uint8_t *row) {
+  int top = page * 8;
+  int first = l->y > top ? l->y : top;
+  int last = (l->y + l->height < top + 8) ? l->y + l->height : top + 8;
+  int c0 = l->x > start ? l->x : start;
+  int c1 = (l->x + l->width < end) ? l->x + l->width : end;
+
+  if (first >= last || c0 >= c1) {
+    return;
+  }
+
+  // Rows of this page the layer covers
+  uint8_t mask =
+      (uint8_t)(((1u << (last - top)) - 1) & ~((1u << (first - top)) - 1));
+
+  // Layer row that lands on bit 0 of this page. Negative when the layer
+  // starts inside the page; otherwise the byte straddles two layer pages
+  // unless the layer is page-aligned.
+  int d = top - l->y;
+  uint8_t pages = (l->height + 7) / 8;
+  const uint8_t *lo = NULL;
+  const uint8_t *hi = NULL;
+  uint8_t shift = 0;
+
+  if (d < 0) {
+    hi = l->pixels;
+  } else {
+    lo = l->pixels + (d >> 3) * l->width;
+    shift = d & 7;
+    if (shift > 0 && (d >> 3) + 1 < pages) {
+      hi = lo + l->width;
+    }
+  }
+
+  for (int c = c0; c < c1; c++) {
+    int lc = c - l->x;
+    uint8_t bits;
+    if (d < 0) {
+      bits = hi[lc] << -d;
+    } else {
+      bits = lo[lc] >> shift;
+      if (hi != NULL) {
+        bits |= hi[lc] << (8 - shift);
+      }
+    }
+    bits &= mask;
+
+    switch (l->blend) {
+    case SH1106_BLEND_OPAQUE:
+      row[c] = (row[c] & ~mask) | bits;
+      break;
+    case SH1106_BLEND_OR:
+      row[c] |= bits;
+      break;
+    case SH1106_BLEND_XOR:
+      row[c] ^= bits;
+      break;
+    case SH1106_BLEND_MASK:
+      row[c] &= ~bits;
+      break;
+    }
+  }
+}
+
+esp_err_t sh1106_compositor_init(sh1106_compositor_t *comp,
+                                 sh1106_handle_t *handle) {
+  if (comp == NULL || handle == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  comp->display = handle;
+  comp->bottom = NULL;
+  // The first render owns the whole screen
+  memset(comp->damage_start, 0, sizeof(comp->damage_start));
+  memset(comp->damage_end, SH1106_WIDTH, sizeof(comp->damage_end));
+
+  return ESP_OK;
+}
+
+esp_err_t sh1106_compositor_add(sh1106_compositor_t *comp,
+                                sh1106_layer_t *layer) {
+  if (comp == NULL || layer == NULL || layer->pixels == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sh1106_layer_t **link = &comp->bottom;
+  while (*link != NULL) {
+    if (*link == layer) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    link = &(*link)->next;
+  }
+
+  layer->next = NULL;
+  layer->shown_visible = false;
+  *link = layer;
+
+  return ESP_OK;
+}
+
+void sh1106_compositor_remove(sh1106_compositor_t *comp,
+                              sh1106_layer_t *layer) {
+  for (sh1106_layer_t **link = &comp->bottom; *link != NULL;
+       link = &(*link)->next) {
+    if (*link == layer) {
+      *link = layer->next;
+      layer->next = NULL;
+      if (layer->shown_visible) {
+        comp_damage(comp, layer->shown_x, layer->shown_y, layer->width,
+                    layer->height);
+        layer->shown_visible = false;
+      }
+      return;
+    }
+  }
+}
+
+esp_err_t sh1106_compositor_render(sh1106_compositor_t *comp) {
+  sh1106_handle_t *handle = comp->display;
+
+  // Layers are composited in the native layout
+  if (sh1106_is_portrait(handle)) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  comp_collect_damage(comp);
+
+  for (uint8_t page = 0; page < SH1106_PAGES; page++) {
+    uint8_t start = comp->damage_start[page];
+    uint8_t end = comp->damage_end[page];
+    if (start >= end) {
+      continue;
+    }
+
+    uint8_t *row = handle->buffer[page];
+    memset(&row[start], 0, end - start);
+    for (sh1106_layer_t *l = comp->bottom; l != NULL; l = l->next) {
+      if (l->visible) {
+        comp_blend_page(l, page, start, end, row);
+      }
+    }
+
+    sh1106_mark_dirty(handle, start, page, end - start, 1);
+    comp->damage_start[page] = SH1106_WIDTH;
+    comp->damage_end[page] = 0;
+  }
+
+  return ESP_OK;
+}
+
+// ============================================================================
+// Layers
+// ============================================================================
+
+esp_err_t sh1106_layer_init(sh1106_layer_t *layer, uint8_t *pixels,
+                            uint8_t width, uint8_t height) {
+  if (layer == NULL || pixels == NULL || width == 0 ||
+      width > SH1106_WIDTH || height == 0 || height > SH1106_HEIGHT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(layer, 0, sizeof(*layer));
+  layer->pixels = pixels;
+  layer->width = width;
+  layer->height = height;
+  layer->blend = SH1106_BLEND_OPAQUE;
+  memset(pixels, 0, SH1106_LAYER_BUF_SIZE(width, height));
+
+  return ESP_OK;
+}
+
+void sh1106_layer_set_position(sh1106_layer_t *layer, int16_t x, int16_t y) {
+  layer->x = x;
+  layer->y = y;
+}
+
+void sh1106_layer_set_visible(sh1106_layer_t *layer, bool visible) {
+  layer->visible = visible;
+}
+
+void sh1106_layer_set_blend(sh1106_layer_t *layer, sh1106_blend_t blend) {
+  if (blend != layer->blend) {
+    layer->blend = blend;
+    sh1106_layer_mark_dirty(layer, 0, 0, layer->width, layer->height);
+  }
+}
+
+void sh1106_layer_mark_dirty(sh1106_layer_t *layer, uint8_t x, uint8_t y,
+                             uint8_t w, uint8_t h) {
+  if (x >= layer->width || y >= layer->height || w == 0 || h == 0) {
+    return;
+  }
+
+  uint8_t x1 = (w > layer->width - x) ? layer->width : x + w;
+  uint8_t y1 = (h > layer->height - y) ? layer->height : y + h;
+
+  if (layer->dirty_x0 >= layer->dirty_x1) {
+    layer->dirty_x0 = x;
+    layer->dirty_y0 = y;
+    layer->dirty_x1 = x1;
+    layer->dirty_y1 = y1;
+    return;
+  }
+
+  if (x < layer->dirty_x0) {
+    layer->dirty_x0 = x;
+  }
+  if (y < layer->dirty_y0) {
+    layer->dirty_y0 = y;
+  }
+  if (x1 > layer->dirty_x1) {
+    layer->dirty_x1 = x1;
+  }
+  if (y1 > layer->dirty_y1) {
+    layer->dirty_y1 = y1;
+  }
+}
+
+void sh1106_layer_clear(sh1106_layer_t *layer) {
+  memset(layer->pixels, 0, SH1106_LAYER_BUF_SIZE(layer->width, layer->height));
+  sh1106_layer_mark_dirty(layer, 0, 0, layer->width, layer->height);
+}
+
+void sh1106_layer_set_pixel(sh1106_layer_t *layer, uint8_t x, uint8_t y,
+                            bool on) {
+  if (x >= layer->width || y >= layer->height) {
+    return;
+  }
+
+  uint8_t *byte = &layer->pixels[(y >> 3) * layer->width + x];
+  if (on) {
+    *byte |= 1 << (y & 7);
+  } else {
+    *byte &= ~(1 << (y & 7));
+  }
+  sh1106_layer_mark_dirty(layer, x, y, 1, 1);
+}
+
+void sh1106_layer_fill_rect(sh1106_layer_t *layer, uint8_t x, uint8_t y,
+                            uint8_t w, uint8_t h, bool on) {
+  if (x >= layer->width || y >= layer->height || w == 0 || h == 0) {
+    return;
+  }
+
+  uint16_t x1 = (x + w < layer->width) ? x + w : layer->width;
+  uint16_t y1 = (y + h < layer->height) ? y + h : layer->height;
+
+  for (uint16_t row = y; row < y1;) {
+    uint8_t page = row >> 3;
+    uint8_t first = row & 7;
+    uint8_t last = (y1 - 1 < (uint16_t)(page * 8 + 7)) ? (y1 - 1) & 7 : 7;
+    uint8_t mask = (uint8_t)((0xFF << first) & (0xFF >> (7 - last)));
+    uint8_t *dst = &layer->pixels[page * layer->width];
+
+    for (uint16_t col = x; col < x1; col++) {
+      dst[col] = on ? (dst[col] | mask) : (dst[col] & ~mask);
+    }
+    row = (page + 1) * 8;
+  }
+
+  sh1106_layer_mark_dirty(layer, x, y, x1 - x, y1 - y);
+}
+
+void sh1106_layer_draw_text(sh1106_layer_t *layer,
+                            sh1106_font_type_t font_type, const char *text,
+                            uint8_t x, uint8_t y) {
+  if (text == NULL || y >= layer->height) {
+    return;
+  }
+
+  const sh1106_font_t *font = sh1106_get_font(font_type);
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 7;
+  uint8_t pages = (layer->height + 7) / 8;
+  uint8_t *row = &layer->pixels[page * layer->width];
+  uint8_t *next_row = (shift > 0 && page + 1 < pages) ? row + layer->width
+                                                      : NULL;
+
+  uint8_t col = x;
+  for (size_t i = 0; text[i] != '\0' && col < layer->width; i++) {
+    uint8_t c = text[i];
+    if (c < font->first_char || c > font->last_char) {
+      continue;
+    }
+
+    const uint8_t *char_data =
+        font->data + (uint16_t)(c - font->first_char) * font->width;
+
+    for (uint8_t j = 0; j < font->width && col < layer->width; j++, col++) {
+      row[col] |= char_data[j] << shift;
+      if (next_row != NULL) {
+        next_row[col] |= char_data[j] >> (8 - shift);
+      }
+    }
+  }
+
+  if (col > x) {
+    sh1106_layer_mark_dirty(layer, x, y, col - x, 8);
+  }
+}
@@ -0,0 +1,184 @@
+#include "sh1106_list.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+static uint8_t *list_row(sh1106_list_t *list, uint8_t row) {
+  return sh1106_fb_row(list->display, list->page + row) + list->x;
+}
+
+static void list_invert_row(sh1106_list_t *list, uint8_t row) {
+  uint8_t *dst = list_row(list, row);
+  for (uint8_t i = 0; i < list->width; i++) {
+    dst[i] ^= 0xFF;
+  }
+  sh1106_mark_dirty(list->display, list->x, list->page + row, list->width, 1);
+}
+
+// Render the item shown in a row, inverted if it is the selection
+static void list_draw_row(sh1106_list_t *list, uint8_t row) {
+  const sh1106_font_t *font = list->font;
+  uint8_t *dst = list_row(list, row);
+  uint32_t index = list->top + row;
+  uint8_t col = 0;
+
+  if (index < list->count) {
+    char buf[SH1106_LIST_TEXT_MAX];
+    const char *text =
+        list->provider.get_item(index, buf, sizeof(buf), list->provider.ctx);
+
+    for (size_t i = 0; text != NULL && text[i] != '\0' &&
+                       col + font->width <= list->width;
+         i++) {
+      uint8_t c = text[i];
+      if (c < font->first_char || c > font->last_char) {
+        continue;
+      }
+      memcpy(&dst[col], font->data + (uint16_t)(c - font->first_char) *
+                                         font->width,
+             font->width);
+      col += font->width;
+    }
+  }
+  memset(&dst[col], 0, list->width - col);
+
+  if (index == list->selected && index < list->count) {
+    list_invert_row(list, row);
+  } else {
+    sh1106_mark_dirty(list->display, list->x, list->page + row, list->width,
+                      1);
+  }
+}
+
+static void list_draw_all(sh1106_list_t *list) {
+  for (uint8_t row = 0; row < list->rows; row++) {
+    list_draw_row(list, row);
+  }
+}
+
+// Move drawn rows by @p shift rows and draw only the rows that come into
+// view. up means the content moves up (the window scrolled down the list).
+static void list_shift_rows(sh1106_list_t *list, bool up, uint8_t shift) {
+  uint8_t keep = list->rows - shift;
+
+  if (up) {
+    for (uint8_t row = 0; row < keep; row++) {
+      memcpy(list_row(list, row), list_row(list, row + shift), list->width);
+    }
+    for (uint8_t row = keep; row < list->rows; row++) {
+      list_draw_row(list, row);
+    }
+  } else {
+    for (uint8_t row = list->rows - 1; row >= shift; row--) {
+      memcpy(list_row(list, row), list_row(list, row - shift), list->width);
+    }
+    for (uint8_t row = 0; row < shift; row++) {
+      list_draw_row(list, row);
+    }
+  }
+
+  sh1106_mark_dirty(list->display, list->x, list->page, list->width,
+                    list->rows);
+}
+
+esp_err_t sh1106_list_init(sh1106_list_t *list, sh1106_handle_t *handle,
+                           const sh1106_list_provider_t *provider,
+                           sh1106_font_type_t font_type, uint8_t x,
+                           uint8_t page, uint8_t width, uint8_t rows) {
+  const sh1106_font_t *font = sh1106_get_font(font_type);
+  if (list == NULL || handle == NULL || provider == NULL ||
+      provider->count == NULL || provider->get_item == NULL || font == NULL ||
+      x >= handle->width || page >= handle->height / 8 || width == 0 ||
+      rows == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  list->display = handle;
+  list->provider = *provider;
+  list->font = font;
+  list->x = x;
+  list->width = (width > handle->width - x) ? handle->width - x : width;
+  list->page = page;
+  list->rows = (rows > handle->height / 8 - page) ? handle->height / 8 - page
+                                                  : rows;
+  list->top = 0;
+  list->selected = 0;
+
+  sh1106_list_refresh(list);
+  return ESP_OK;
+}
+
+void sh1106_list_refresh(sh1106_list_t *list) {
+  list->count = list->provider.count(list->provider.ctx);
+
+  if (list->selected >= list->count) {
+    list->selected = list->count > 0 ? list->count - 1 : 0;
+  }
+  if (list->top > list->selected) {
+    list->top = list->selected;
+  } else if (list->selected >= list->top + list->rows) {
+    list->top = list->selected - list->rows + 1;
+  }
+
+  list_draw_all(list);
+}
+
+void sh1106_list_select(sh1106_list_t *list, uint32_t index) {
+  if (list->count == 0) {
+    return;
+  }
+  if (index >= list->count) {
+    index = list->count - 1;
+  }
+  if (index == list->selected) {
+    return;
+  }
+
+  uint32_t old_sel = list->selected;
+  uint32_t old_top = list->top;
+  list->selected = index;
+
+  if (index < list->top) {
+    list->top = index;
+  } else if (index >= list->top + list->rows) {
+    list->top = index - list->rows + 1;
+  }
+
+  // Still on the same screen: just move the highlight
+  if (list->top == old_top) {
+    list_invert_row(list, old_sel - list->top);
+    list_invert_row(list, index - list->top);
+    return;
+  }
+
+  uint32_t shift =
+      list->top > old_top ? list->top - old_top : old_top - list->top;
+  if (shift >= list->rows) {
+    list_draw_all(list);
+    return;
+  }
+
+  list_shift_rows(list, list->top > old_top, shift);
+
+  // Shifted rows carry their old highlight: clear it from the previous
+  // selection and add it to the new one unless that row was just drawn
+  if (old_sel >= list->top && old_sel < list->top + list->rows) {
+    list_invert_row(list, old_sel - list->top);
+  }
+  if (index >= old_top && index < old_top + list->rows) {
+    list_invert_row(list, index - list->top);
+  }
+}
+
+void sh1106_list_move(sh1106_list_t *list, int32_t delta) {
+  if (list->count == 0) {
+    return;
+  }
+
+  int64_t target = (int64_t)list->selected + delta;
+  if (target < 0) {
+    target = 0;
+  } else if (target >= list->count) {
+    target = list->count - 1;
+  }
+  sh1106_list_select(list, (uint32_t)target);
+}
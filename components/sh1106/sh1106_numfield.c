@@ -0,0 +1,142 @@
+#include "sh1106_numfield.h"
+#include "sh1106_priv.h"
+#include <math.h>
+#include <string.h>
+
+static const uint32_t numfield_pow10[] = {
+    1,      10,      100,      1000,      10000,
+    100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// Draw the cells whose glyph differs from what is on screen
+static void numfield_draw(sh1106_numfield_t *field, const char *text) {
+  sh1106_handle_t *handle = field->display;
+  const sh1106_font_t *font = field->font;
+
+  if (field->page >= handle->height / 8) {
+    return;
+  }
+  uint8_t *row = sh1106_fb_row(handle, field->page);
+
+  for (uint8_t i = 0; i < field->cells; i++) {
+    if (text[i] == field->shown[i]) {
+      continue;
+    }
+    field->shown[i] = text[i];
+
+    uint16_t col = field->x + (uint16_t)i * font->width;
+    if (col >= handle->width) {
+      break;
+    }
+    uint8_t width = font->width;
+    if (width > handle->width - col) {
+      width = handle->width - col;
+    }
+
+    uint8_t c = text[i];
+    if (c >= font->first_char && c <= font->last_char) {
+      memcpy(&row[col], font->data + (uint16_t)(c - font->first_char) *
+                                         font->width,
+             width);
+    } else {
+      memset(&row[col], 0, width);
+    }
+    sh1106_mark_dirty(handle, col, field->page, width, 1);
+  }
+}
+
+// Format |value| / 10^decimals right-aligned into the field's cells,
+// without printf. Digits are produced least significant first.
+static void numfield_format(sh1106_numfield_t *field, uint32_t magnitude,
+                            bool negative, uint8_t decimals) {
+  char digits[SH1106_NUMFIELD_MAX_CELLS + 2];
+  uint8_t n = 0;
+  uint8_t produced = 0;
+
+  do {
+    if (decimals > 0 && produced == decimals) {
+      digits[n++] = '.';
+    }
+    digits[n++] = '0' + magnitude % 10;
+    magnitude /= 10;
+    produced++;
+  } while ((magnitude > 0 || produced <= decimals) &&
+           n < sizeof(digits) - 1);
+  if (negative) {
+    digits[n++] = '-';
+  }
+
+  char text[SH1106_NUMFIELD_MAX_CELLS];
+  if (magnitude > 0 || n > field->cells) {
+    memset(text, '#', field->cells);
+  } else {
+    uint8_t pad = field->cells - n;
+    memset(text, ' ', pad);
+    for (uint8_t i = 0; i < n; i++) {
+      text[pad + i] = digits[n - 1 - i];
+    }
+  }
+
+  numfield_draw(field, text);
+}
+
+esp_err_t sh1106_numfield_init(sh1106_numfield_t *field,
+                               sh1106_handle_t *handle,
+                               sh1106_font_type_t font_type, uint8_t x,
+                               uint8_t page, uint8_t cells) {
+  const sh1106_font_t *font = sh1106_get_font(font_type);
+  if (field == NULL || handle == NULL || font == NULL || cells == 0 ||
+      cells > SH1106_NUMFIELD_MAX_CELLS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  field->display = handle;
+  field->font = font;
+  field->x = x;
+  field->page = page;
+  field->cells = cells;
+  sh1106_numfield_invalidate(field);
+
+  return ESP_OK;
+}
+
+void sh1106_numfield_set_int(sh1106_numfield_t *field, int32_t value) {
+  sh1106_numfield_set_fixed(field, value, 0);
+}
+
+void sh1106_numfield_set_fixed(sh1106_numfield_t *field, int32_t value,
+                               uint8_t decimals) {
+  if (decimals > 9) {
+    decimals = 9;
+  }
+  // Negate in unsigned arithmetic so INT32_MIN is safe
+  uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+  numfield_format(field, magnitude, value < 0, decimals);
+}
+
+void sh1106_numfield_set_float(sh1106_numfield_t *field, float value,
+                               uint8_t precision) {
+  if (precision > 9) {
+    precision = 9;
+  }
+
+  bool negative = value < 0.0f;
+  float scaled = (negative ? -value : value) * numfield_pow10[precision];
+
+  // NaN and anything from 2^32 up cannot be shown. 4294967295.0f is not
+  // representable and would itself round to 2^32.
+  if (isnan(scaled) || scaled >= 4294967296.0f) {
+    char text[SH1106_NUMFIELD_MAX_CELLS];
+    memset(text, '#', field->cells);
+    numfield_draw(field, text);
+    return;
+  }
+
+  uint32_t magnitude = (uint32_t)(scaled + 0.5f);
+  // Values that round to zero lose their sign
+  numfield_format(field, magnitude, negative && magnitude > 0, precision);
+}
+
+void sh1106_numfield_invalidate(sh1106_numfield_t *field) {
+  memset(field->shown, 0, sizeof(field->shown));
+}
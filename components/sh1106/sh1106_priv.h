@@ -0,0 +1,126 @@
+#ifndef SH1106_PRIV_H
+#define SH1106_PRIV_H
+
+// Internal helpers shared between the driver's translation units.
+// Not part of the public API.
+
+#include "sh1106.h"
+#include "sh1106_trace.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Send one page span as a single bus transaction
+ *
+ * Page address, column address and the pixel bytes go out back-to-back so
+ * the controller sees one transfer per page instead of four. The transfer
+ * may still be in flight on return; see sh1106_wait_idle().
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param page Page address (0-7)
+ * @param col First visible column, SH1106_COLUMN_OFFSET is added here
+ * @param data Column bytes to write
+ * @param len Number of bytes
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_write_page(sh1106_handle_t *handle, uint8_t page, uint8_t col,
+                            const uint8_t *data, size_t len);
+
+/**
+ * @brief Send whole pages from a page-major buffer
+ *
+ * The SSD1306 takes them as one transaction through a horizontal-addressing
+ * window; the SH1106 needs one per page. Same completion rules as
+ * sh1106_write_page().
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param page First page
+ * @param pages Number of pages
+ * @param data pages * SH1106_WIDTH bytes
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_write_pages(sh1106_handle_t *handle, uint8_t page,
+                             uint8_t pages, const uint8_t *data);
+
+/**
+ * @brief Wait until queued page transfers have completed
+ *
+ * Page data handed to sh1106_write_page() must not change before this
+ * returns (transports such as SPI queue the transfer and return early).
+ *
+ * @param handle Pointer to SH1106 handle
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_wait_idle(sh1106_handle_t *handle);
+
+/**
+ * @brief Send a run of command bytes as a single bus transaction
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param cmds Command bytes (including any argument bytes)
+ * @param len Number of bytes
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_write_commands(sh1106_handle_t *handle, const uint8_t *cmds,
+                                size_t len);
+
+#if SH1106_BUS_DRIVERS
+/**
+ * @brief Reconfigure the I2C bus clock
+ *
+ * @param handle Pointer to SH1106 handle (port and pins already set)
+ * @param hz Clock in Hz
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_i2c_set_clock(sh1106_handle_t *handle, uint32_t hz);
+
+/**
+ * @brief Count an I2C transfer result and step the clock down on errors
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param ret Result of the transfer
+ */
+void sh1106_i2c_account(sh1106_handle_t *handle, esp_err_t ret);
+#endif
+
+// True for 90/270 degree rotation, where the framebuffer holds a 64x128
+// logical canvas
+static inline bool sh1106_is_portrait(const sh1106_handle_t *handle) {
+  return handle->width != SH1106_WIDTH;
+}
+
+#if CONFIG_SH1106_FRAMEBUFFER
+// Start of a logical framebuffer page (handle->width bytes long)
+static inline uint8_t *sh1106_fb_row(sh1106_handle_t *handle, uint8_t page) {
+  return &handle->buffer[0][0] + (size_t)page * handle->width;
+}
+
+/**
+ * @brief Transpose the portrait canvas into one panel page and send it
+ *
+ * Builds columns [start, end) of panel page @p page from 8x8 tiles of the
+ * logical canvas and waits for the transfer, since the tile buffer is local.
+ *
+ * @param handle Pointer to SH1106 handle
+ * @param page Panel page (0-7)
+ * @param start First panel column, a multiple of 8
+ * @param end One past the last panel column, a multiple of 8
+ * @return esp_err_t ESP_OK on success
+ */
+esp_err_t sh1106_rotate_write_page(sh1106_handle_t *handle, uint8_t page,
+                                   uint8_t start, uint8_t end);
+
+/**
+ * @brief Width of text in pixels, skipping characters the font lacks
+ *
+ * @param font Font
+ * @param text Text
+ * @param len Characters to measure (stops early at '\0')
+ * @return uint16_t Width in pixels
+ */
+uint16_t sh1106_font_text_width(const sh1106_font_t *font, const char *text,
+                                size_t len);
+#endif // CONFIG_SH1106_FRAMEBUFFER
+
+#endif // SH1106_PRIV_H
@@ -0,0 +1,43 @@
+#include "sh1106_priv.h"
+#include <string.h>
+
+// Portrait layout (90 degrees): logical pixel (lx, ly) of the 64x128 canvas
+// lands on panel pixel (127 - ly, lx). An 8x8 tile at logical page lp and
+// columns 8c..8c+7 therefore becomes panel page c, columns 8(15-lp)..+7,
+// with rows and columns swapped and the column order reversed.
+
+// Swap bit (i, j) with bit (j, i) of an 8x8 matrix held one row per byte,
+// row i in bits 8i..8i+7. Three delta swaps instead of 64 bit moves.
+static inline uint64_t sh1106_transpose8x8(uint64_t x) {
+  uint64_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+  x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+  x ^= t ^ (t << 28);
+  return x;
+}
+
+esp_err_t sh1106_rotate_write_page(sh1106_handle_t *handle, uint8_t page,
+                                   uint8_t start, uint8_t end) {
+  const uint8_t *fb = &handle->buffer[0][0];
+  uint8_t out[SH1106_WIDTH];
+
+  for (uint8_t col = start; col < end; col += 8) {
+    uint8_t lpage = (SH1106_WIDTH - 8 - col) / 8;
+    uint64_t tile;
+
+    // Logical pages are SH1106_HEIGHT columns wide and the 8 columns of a
+    // tile are contiguous. The word is read little-endian, as on both
+    // Xtensa and RISC-V targets.
+    memcpy(&tile, fb + lpage * SH1106_HEIGHT + page * 8, sizeof(tile));
+    tile = __builtin_bswap64(sh1106_transpose8x8(tile));
+    memcpy(&out[col], &tile, sizeof(tile));
+  }
+
+  esp_err_t ret =
+      sh1106_write_page(handle, page, start, &out[start], end - start);
+  esp_err_t err = sh1106_wait_idle(handle);
+  return ret != ESP_OK ? ret : err;
+}
@@ -0,0 +1,165 @@
+#include "sh1106_sprite.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+typedef struct {
+  int16_t x0, y0, x1, y1; // [x0, x1) x [y0, y1), clipped to the display
+} sprite_clip_t;
+
+static bool sprite_clip(const sh1106_handle_t *handle, int16_t x, int16_t y,
+                        uint8_t w, uint8_t h, sprite_clip_t *clip) {
+  clip->x0 = x < 0 ? 0 : x;
+  clip->y0 = y < 0 ? 0 : y;
+  clip->x1 = (x + w < handle->width) ? x + w : handle->width;
+  clip->y1 = (y + h < handle->height) ? y + h : handle->height;
+  return clip->x0 < clip->x1 && clip->y0 < clip->y1;
+}
+
+static void sprite_mark_dirty(sh1106_handle_t *handle,
+                              const sprite_clip_t *clip) {
+  uint8_t first = clip->y0 / 8;
+  uint8_t last = (clip->y1 - 1) / 8;
+  sh1106_mark_dirty(handle, clip->x0, first, clip->x1 - clip->x0,
+                    last - first + 1);
+}
+
+static void sprite_clear_box(sh1106_handle_t *handle,
+                             const sprite_clip_t *clip) {
+  for (uint8_t page = clip->y0 / 8; page <= (clip->y1 - 1) / 8; page++) {
+    int16_t top = clip->y0 - page * 8;
+    int16_t bottom = clip->y1 - 1 - page * 8;
+    top = top < 0 ? 0 : top;
+    bottom = bottom > 7 ? 7 : bottom;
+    uint8_t keep = ~((0xFFu << top) & (0xFFu >> (7 - bottom)));
+
+    uint8_t *row = sh1106_fb_row(handle, page);
+    for (int16_t x = clip->x0; x < clip->x1; x++) {
+      row[x] &= keep;
+    }
+  }
+}
+
+// OR a page-major frame into the framebuffer at any pixel position
+static void sprite_blit(sh1106_handle_t *handle,
+                        const sh1106_sprite_frame_t *f, const uint8_t *data,
+                        int16_t bx, int16_t by) {
+  uint8_t src_pages = (f->height + 7) / 8;
+  uint8_t dst_pages = handle->height / 8;
+
+  for (uint8_t p = 0; p < src_pages; p++) {
+    int16_t y = by + p * 8;
+    if (y <= -8 || y >= handle->height) {
+      continue;
+    }
+
+    const uint8_t *src = data + (size_t)p * f->width;
+    int16_t page = y >= 0 ? y / 8 : -1;
+    uint8_t shift = y & 7;
+    uint8_t *upper = page >= 0 ? sh1106_fb_row(handle, page) : NULL;
+    uint8_t *lower = (shift != 0 && page + 1 < dst_pages)
+                         ? sh1106_fb_row(handle, page + 1)
+                         : NULL;
+
+    for (uint8_t i = 0; i < f->width; i++) {
+      int16_t x = bx + i;
+      if (x < 0 || x >= handle->width) {
+        continue;
+      }
+      if (upper != NULL) {
+        upper[x] |= src[i] << shift;
+      }
+      if (lower != NULL) {
+        lower[x] |= src[i] >> (8 - shift);
+      }
+    }
+  }
+}
+
+// Replace the box drawn last with @p frame at cell position (x, y)
+static void sprite_show(sh1106_sprite_t *sprite, int16_t x, int16_t y,
+                        uint16_t frame) {
+  sh1106_handle_t *handle = sprite->display;
+  const sh1106_sprite_def_t *def = sprite->def;
+  const sh1106_sprite_frame_t *f =
+      &sprite->atlas->frames[def->first_frame + frame % def->frame_count];
+  sprite_clip_t clip;
+
+  if (sprite->box_w != 0 && sprite_clip(handle, sprite->box_x, sprite->box_y,
+                                        sprite->box_w, sprite->box_h, &clip)) {
+    sprite_clear_box(handle, &clip);
+    sprite_mark_dirty(handle, &clip);
+  }
+
+  sprite->frame = frame % def->frame_count;
+  sprite->x = x;
+  sprite->y = y;
+  sprite->box_x = x + f->dx;
+  sprite->box_y = y + f->dy;
+  sprite->box_w = f->width;
+  sprite->box_h = f->height;
+  sprite->shown = true;
+
+  if (f->width != 0 && sprite_clip(handle, sprite->box_x, sprite->box_y,
+                                   f->width, f->height, &clip)) {
+    // Opaque inside the inked box
+    sprite_clear_box(handle, &clip);
+    sprite_blit(handle, f, sprite->atlas->data + f->offset, sprite->box_x,
+                sprite->box_y);
+    sprite_mark_dirty(handle, &clip);
+  }
+}
+
+esp_err_t sh1106_sprite_init(sh1106_sprite_t *sprite, sh1106_handle_t *handle,
+                             const sh1106_sprite_atlas_t *atlas, uint16_t id) {
+  if (sprite == NULL || handle == NULL || atlas == NULL ||
+      id >= atlas->sprite_count || atlas->sprites[id].frame_count == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(sprite, 0, sizeof(*sprite));
+  sprite->display = handle;
+  sprite->atlas = atlas;
+  sprite->def = &atlas->sprites[id];
+  return ESP_OK;
+}
+
+void sh1106_sprite_draw(sh1106_sprite_t *sprite, int16_t x, int16_t y,
+                        uint16_t frame) {
+  sprite->elapsed_ms = 0;
+  sprite_show(sprite, x, y, frame);
+}
+
+bool sh1106_sprite_tick(sh1106_sprite_t *sprite, uint32_t elapsed_ms) {
+  const sh1106_sprite_def_t *def = sprite->def;
+  if (!sprite->shown || def->frame_ms == 0 || def->frame_count < 2) {
+    return false;
+  }
+
+  sprite->elapsed_ms += elapsed_ms;
+  if (sprite->elapsed_ms < def->frame_ms) {
+    return false;
+  }
+
+  // Skip frames the caller was too late for instead of replaying them
+  uint32_t steps = sprite->elapsed_ms / def->frame_ms;
+  sprite->elapsed_ms %= def->frame_ms;
+  uint16_t frame = (sprite->frame + steps) % def->frame_count;
+  if (frame == sprite->frame) {
+    return false;
+  }
+
+  sprite_show(sprite, sprite->x, sprite->y, frame);
+  return true;
+}
+
+void sh1106_sprite_hide(sh1106_sprite_t *sprite) {
+  sprite_clip_t clip;
+  if (sprite->box_w != 0 &&
+      sprite_clip(sprite->display, sprite->box_x, sprite->box_y,
+                  sprite->box_w, sprite->box_h, &clip)) {
+    sprite_clear_box(sprite->display, &clip);
+    sprite_mark_dirty(sprite->display, &clip);
+  }
+  sprite->box_w = 0;
+  sprite->shown = false;
+}
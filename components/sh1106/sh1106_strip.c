@@ -0,0 +1,154 @@
+#include "sh1106_strip.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+static const char *TAG = "SH1106_STRIP";
+
+esp_err_t sh1106_render_strips(sh1106_handle_t *handle,
+                               sh1106_strip_draw_cb_t draw, void *ctx) {
+  esp_err_t ret = ESP_OK;
+  uint8_t n = 0;
+
+  // Strips are bands of the native layout
+  if (sh1106_is_portrait(handle)) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  SH1106_TRACE(SH1106_TRACE_FLUSH_BEGIN, SH1106_TRACE_FLUSH_STRIPS, 0);
+  int64_t start = esp_timer_get_time();
+
+  for (uint8_t page = 0; page < SH1106_PAGES; page += SH1106_STRIP_PAGES) {
+    sh1106_strip_t strip = {
+        .page = page,
+        .pages = (SH1106_PAGES - page < SH1106_STRIP_PAGES)
+                     ? SH1106_PAGES - page
+                     : SH1106_STRIP_PAGES,
+    };
+
+#if CONFIG_SH1106_FRAMEBUFFER
+    strip.buf = &handle->buffer[page];
+#else
+    // Alternate buffers: this one was last sent two strips ago, and the wait
+    // below for the previous strip has already retired it
+    strip.buf = handle->strip_buf[n & 1];
+#endif
+    memset(strip.buf, 0, (size_t)strip.pages * SH1106_WIDTH);
+
+    // Render while the previous strip is still being transmitted
+    if (draw != NULL) {
+      ret = draw(&strip, ctx);
+      if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Draw callback aborted frame at page %u", page);
+        break;
+      }
+    }
+
+    ret = sh1106_wait_idle(handle);
+    if (ret == ESP_OK) {
+      ret = sh1106_write_pages(handle, strip.page, strip.pages,
+                               &strip.buf[0][0]);
+    }
+    if (ret != ESP_OK) {
+      break;
+    }
+    n++;
+  }
+
+  esp_err_t err = sh1106_wait_idle(handle);
+  if (ret == ESP_OK) {
+    ret = err;
+  }
+  SH1106_TRACE(SH1106_TRACE_FLUSH_END, SH1106_TRACE_FLUSH_STRIPS, 0);
+  handle->frame_us = (uint32_t)(esp_timer_get_time() - start);
+
+#if CONFIG_SH1106_FRAMEBUFFER
+  if (ret == ESP_OK) {
+    memset(handle->dirty_start, SH1106_WIDTH, sizeof(handle->dirty_start));
+    memset(handle->dirty_end, 0, sizeof(handle->dirty_end));
+  }
+#endif
+
+  return ret;
+}
+
+void sh1106_strip_set_pixel(sh1106_strip_t *strip, uint8_t x, uint8_t y,
+                            bool on) {
+  uint8_t page = y >> 3;
+  if (x >= SH1106_WIDTH || page < strip->page ||
+      page >= strip->page + strip->pages) {
+    return;
+  }
+
+  uint8_t *byte = &strip->buf[page - strip->page][x];
+  if (on) {
+    *byte |= 1 << (y & 7);
+  } else {
+    *byte &= ~(1 << (y & 7));
+  }
+}
+
+void sh1106_strip_fill_rect(sh1106_strip_t *strip, uint8_t x, uint8_t y,
+                            uint8_t w, uint8_t h, bool on) {
+  uint16_t top = strip->page * 8;
+  uint16_t bottom = (strip->page + strip->pages) * 8;
+  uint16_t y0 = y > top ? y : top;
+  uint16_t y1 = (y + h < bottom) ? y + h : bottom;
+  uint16_t x1 = (x + w < SH1106_WIDTH) ? x + w : SH1106_WIDTH;
+
+  if (y0 >= y1 || x >= x1) {
+    return;
+  }
+
+  for (uint16_t row = y0; row < y1;) {
+    uint8_t page = row >> 3;
+    uint8_t first = row & 7;
+    uint8_t last = (y1 - 1 < (uint16_t)(page * 8 + 7)) ? (y1 - 1) & 7 : 7;
+    uint8_t mask = (uint8_t)((0xFF << first) & (0xFF >> (7 - last)));
+    uint8_t *dst = strip->buf[page - strip->page];
+
+    for (uint16_t col = x; col < x1; col++) {
+      dst[col] = on ? (dst[col] | mask) : (dst[col] & ~mask);
+    }
+    row = (page + 1) * 8;
+  }
+}
+
+void sh1106_strip_draw_text(sh1106_strip_t *strip,
+                            sh1106_font_type_t font_type, const char *text,
+                            uint8_t x, uint8_t y) {
+  if (text == NULL) {
+    return;
+  }
+
+  const sh1106_font_t *font = sh1106_get_font(font_type);
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 7;
+  uint8_t last = strip->page + strip->pages;
+
+  // Glyphs are one page tall; skip text entirely outside the strip
+  if (page >= last || page + (shift ? 1 : 0) < strip->page) {
+    return;
+  }
+
+  uint8_t col = x;
+  for (size_t i = 0; text[i] != '\0' && col < SH1106_WIDTH; i++) {
+    uint8_t c = text[i];
+    if (c < font->first_char || c > font->last_char) {
+      continue;
+    }
+
+    const uint8_t *char_data =
+        font->data + (uint16_t)(c - font->first_char) * font->width;
+
+    for (uint8_t j = 0; j < font->width && col < SH1106_WIDTH; j++, col++) {
+      uint8_t bits = char_data[j];
+      if (page >= strip->page) {
+        strip->buf[page - strip->page][col] |= bits << shift;
+      }
+      if (shift > 0 && page + 1 >= strip->page && page + 1 < last) {
+        strip->buf[page + 1 - strip->page][col] |= bits >> (8 - shift);
+      }
+    }
+  }
+}
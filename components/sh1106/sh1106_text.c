@@ -0,0 +1,304 @@
+#include "sh1106_text.h"
+#include "sh1106_priv.h"
+#include <string.h>
+
+#define TEXT_ELLIPSIS_DOTS 3
+
+static uint8_t text_glyph_width(const sh1106_font_t *font, uint8_t c) {
+  return (c >= font->first_char && c <= font->last_char) ? font->width : 0;
+}
+
+uint16_t sh1106_font_text_width(const sh1106_font_t *font, const char *text,
+                                size_t len) {
+  uint16_t width = 0;
+  for (size_t i = 0; i < len && text[i] != '\0'; i++) {
+    width += text_glyph_width(font, text[i]);
+  }
+  return width;
+}
+
+uint16_t sh1106_text_width(sh1106_font_type_t font_type, const char *text) {
+  const sh1106_font_t *font = sh1106_get_font(font_type);
+  uint16_t widest = 0;
+  uint16_t width = 0;
+
+  for (size_t i = 0; text != NULL && text[i] != '\0'; i++) {
+    if (text[i] == '\n') {
+      width = 0;
+      continue;
+    }
+    width += text_glyph_width(font, text[i]);
+    if (width > widest) {
+      widest = width;
+    }
+  }
+  return widest;
+}
+
+static uint8_t text_pitch(const sh1106_text_box_t *box) {
+  return box->font->height + box->config.line_spacing;
+}
+
+// Cut the last line so "..." fits after it
+static void text_add_ellipsis(sh1106_text_box_t *box, const char *text) {
+  const sh1106_font_t *font = box->font;
+  uint8_t dots = TEXT_ELLIPSIS_DOTS * text_glyph_width(font, '.');
+  if (box->line_count == 0 || dots == 0 || dots > box->width) {
+    return;
+  }
+
+  sh1106_text_line_t *line = &box->lines[box->line_count - 1];
+  while (line->len > 0 &&
+         (line->width + dots > box->width ||
+          text[line->start + line->len - 1] == ' ')) {
+    line->len--;
+    line->width -= text_glyph_width(font, text[line->start + line->len]);
+  }
+  line->width += dots;
+  line->flags = SH1106_TEXT_LINE_ELLIPSIS;
+}
+
+// Greedy word wrap. Words longer than the box are broken at the edge.
+static void text_break_lines(sh1106_text_box_t *box, const char *text) {
+  const sh1106_font_t *font = box->font;
+  uint8_t spacing = box->config.line_spacing;
+  uint16_t max_lines = (box->height + spacing) / text_pitch(box);
+  if (max_lines > SH1106_TEXT_MAX_LINES) {
+    max_lines = SH1106_TEXT_MAX_LINES;
+  }
+
+  box->line_count = 0;
+  box->overflow = false;
+  uint16_t pos = 0;
+
+  while (pos < box->text_len) {
+    if (box->line_count == max_lines) {
+      box->overflow = true;
+      break;
+    }
+
+    uint16_t start = pos;
+    uint16_t i = pos;
+    uint16_t brk = start; // Last space that could end the line
+    uint16_t px = 0;
+    uint8_t flags = 0;
+
+    while (i < box->text_len && text[i] != '\n') {
+      uint8_t w = text_glyph_width(font, text[i]);
+      if (px + w > box->width) {
+        break;
+      }
+      if (text[i] == ' ') {
+        brk = i;
+      }
+      px += w;
+      i++;
+    }
+
+    uint16_t end;
+    if (i == box->text_len || text[i] == '\n') {
+      end = i;
+      pos = (i < box->text_len) ? i + 1 : i;
+    } else {
+      flags = SH1106_TEXT_LINE_JUSTIFY;
+      if (text[i] == ' ') {
+        end = i;
+      } else if (brk > start) {
+        end = brk;
+      } else {
+        end = (i > start) ? i : start + 1; // At least one glyph per line
+      }
+      // The wrap replaces the spaces, and a newline right after them
+      pos = end;
+      while (pos < box->text_len && text[pos] == ' ') {
+        pos++;
+      }
+      if (pos < box->text_len && text[pos] == '\n') {
+        pos++;
+      }
+    }
+
+    while (end > start && text[end - 1] == ' ') {
+      end--;
+    }
+
+    sh1106_text_line_t *line = &box->lines[box->line_count++];
+    line->start = start;
+    line->len = end - start;
+    line->width = sh1106_font_text_width(font, &text[start], end - start);
+    line->flags = flags;
+  }
+
+  if (box->overflow && box->config.ellipsis) {
+    text_add_ellipsis(box, text);
+  }
+}
+
+// OR one glyph column into the framebuffer at any pixel row, clipped to
+// the box
+static void text_put_column(sh1106_text_box_t *box, uint16_t col, int16_t row,
+                            uint8_t bits) {
+  // A glyph wider than the box is forced onto its line and runs past it
+  if (col >= box->x + box->width) {
+    return;
+  }
+
+  int16_t rows_left = box->y + box->height - row;
+  if (rows_left < 8) {
+    bits &= (uint8_t)((1u << rows_left) - 1);
+  }
+
+  uint8_t page = row / 8;
+  uint8_t shift = row % 8;
+  sh1106_fb_row(box->display, page)[col] |= bits << shift;
+  if (shift != 0 && page + 1 < box->display->height / 8) {
+    sh1106_fb_row(box->display, page + 1)[col] |= bits >> (8 - shift);
+  }
+}
+
+static uint8_t text_put_glyph(sh1106_text_box_t *box, uint16_t col,
+                              int16_t row, uint8_t c) {
+  const sh1106_font_t *font = box->font;
+  if (c < font->first_char || c > font->last_char) {
+    return 0;
+  }
+
+  const uint8_t *data = font->data + (uint16_t)(c - font->first_char) *
+                                         font->width;
+  for (uint8_t j = 0; j < font->width; j++) {
+    text_put_column(box, col + j, row, data[j]);
+  }
+  return font->width;
+}
+
+static void text_draw_line(sh1106_text_box_t *box, const char *text,
+                           const sh1106_text_line_t *line, int16_t row) {
+  uint8_t slack = line->width < box->width ? box->width - line->width : 0;
+  uint16_t col = box->x;
+  uint16_t gaps = 0;
+
+  switch (box->config.align) {
+  case SH1106_ALIGN_CENTER:
+    col += slack / 2;
+    break;
+  case SH1106_ALIGN_RIGHT:
+    col += slack;
+    break;
+  case SH1106_ALIGN_JUSTIFY:
+    if (line->flags & SH1106_TEXT_LINE_JUSTIFY) {
+      for (uint16_t i = 0; i < line->len; i++) {
+        gaps += text[line->start + i] == ' ';
+      }
+    }
+    break;
+  default:
+    break;
+  }
+
+  uint16_t gap = 0;
+  for (uint16_t i = 0; i < line->len; i++) {
+    uint8_t c = text[line->start + i];
+    col += text_put_glyph(box, col, row, c);
+    // Spread the slack over the spaces, the first ones one pixel wider
+    if (c == ' ' && gaps > 0) {
+      col += slack / gaps + (gap < slack % gaps ? 1 : 0);
+      gap++;
+    }
+  }
+
+  if (line->flags & SH1106_TEXT_LINE_ELLIPSIS) {
+    for (uint8_t i = 0; i < TEXT_ELLIPSIS_DOTS; i++) {
+      col += text_put_glyph(box, col, row, '.');
+    }
+  }
+}
+
+static void text_clear_box(sh1106_text_box_t *box) {
+  uint8_t first = box->y / 8;
+  uint8_t last = (box->y + box->height - 1) / 8;
+
+  for (uint8_t page = first; page <= last; page++) {
+    int16_t top = box->y - page * 8;
+    int16_t bottom = box->y + box->height - 1 - page * 8;
+    top = top < 0 ? 0 : top;
+    bottom = bottom > 7 ? 7 : bottom;
+    uint8_t keep = ~((0xFFu << top) & (0xFFu >> (7 - bottom)));
+
+    uint8_t *row = sh1106_fb_row(box->display, page) + box->x;
+    for (uint8_t i = 0; i < box->width; i++) {
+      row[i] &= keep;
+    }
+  }
+}
+
+esp_err_t sh1106_text_box_init(sh1106_text_box_t *box, sh1106_handle_t *handle,
+                               const sh1106_text_config_t *config, uint8_t x,
+                               uint8_t y, uint8_t width, uint8_t height) {
+  if (box == NULL || handle == NULL || x >= handle->width ||
+      y >= handle->height || width == 0 || height == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(box, 0, sizeof(*box));
+  box->display = handle;
+  if (config != NULL) {
+    box->config = *config;
+  } else {
+    box->config = (sh1106_text_config_t)SH1106_TEXT_CONFIG_DEFAULT();
+  }
+  if (box->config.align > SH1106_ALIGN_JUSTIFY) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  box->font = sh1106_get_font(box->config.font);
+  box->x = x;
+  box->y = y;
+  box->width = (width > handle->width - x) ? handle->width - x : width;
+  box->height = (height > handle->height - y) ? handle->height - y : height;
+  return ESP_OK;
+}
+
+esp_err_t sh1106_text_box_layout(sh1106_text_box_t *box, const char *text) {
+  if (box == NULL || text == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  size_t len = strlen(text);
+  if (box->valid && len == box->text_len &&
+      memcmp(text, box->text, len) == 0) {
+    return ESP_OK;
+  }
+
+  box->text_len = len > UINT16_MAX ? UINT16_MAX : (uint16_t)len;
+  // Only a text that fits the copy can be recognised next time
+  box->valid = len < sizeof(box->text);
+  if (box->valid) {
+    memcpy(box->text, text, len + 1);
+  }
+  box->drawn = false;
+  text_break_lines(box, text);
+  return ESP_OK;
+}
+
+esp_err_t sh1106_text_box_draw(sh1106_text_box_t *box, const char *text) {
+  esp_err_t ret = sh1106_text_box_layout(box, text);
+  if (ret != ESP_OK || box->drawn) {
+    return ret;
+  }
+
+  text_clear_box(box);
+  for (uint8_t i = 0; i < box->line_count; i++) {
+    text_draw_line(box, text, &box->lines[i], box->y + i * text_pitch(box));
+  }
+
+  uint8_t first = box->y / 8;
+  uint8_t last = (box->y + box->height - 1) / 8;
+  sh1106_mark_dirty(box->display, box->x, first, box->width,
+                    last - first + 1);
+  box->drawn = true;
+  return ESP_OK;
+}
+
+void sh1106_text_box_invalidate(sh1106_text_box_t *box) {
+  box->drawn = false;
+}
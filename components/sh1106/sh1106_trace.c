@@ -0,0 +1,184 @@
+#include "sh1106_trace.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TRACE_DEPTH CONFIG_SH1106_TRACE_DEPTH
+#define TRACE_HEADER_SIZE 16
+#define TRACE_EVENT_SIZE 12
+
+static sh1106_trace_event_t s_ring[TRACE_DEPTH];
+static atomic_uint s_head; // Events recorded since the last reset
+
+// Chrome trace-event name, phase and argument names per event type
+typedef struct {
+  const char *name;
+  char phase;
+  const char *arg8;
+  const char *arg16;
+} trace_desc_t;
+
+static const trace_desc_t s_desc[] = {
+    [SH1106_TRACE_TEXT_BEGIN] = {"text", 'B', "page", NULL},
+    [SH1106_TRACE_TEXT_END] = {"text", 'E', "page", "cols"},
+    [SH1106_TRACE_CLEAR] = {"clear", 'i', "page", "pages"},
+    [SH1106_TRACE_FLUSH_BEGIN] = {NULL, 'B', NULL, NULL},
+    [SH1106_TRACE_FLUSH_END] = {NULL, 'E', NULL, NULL},
+    [SH1106_TRACE_PAGE_BEGIN] = {"page", 'B', "page", "bytes"},
+    [SH1106_TRACE_PAGE_END] = {"page", 'E', "page", "bytes"},
+    [SH1106_TRACE_BUS_ERROR] = {"bus_error", 'i', "page", "err"},
+    [SH1106_TRACE_USER] = {"user", 'i', "arg8", "arg16"},
+};
+
+static const char *s_flush_names[] = {
+    [SH1106_TRACE_FLUSH_FULL] = "update_display",
+    [SH1106_TRACE_FLUSH_DIRTY] = "update_dirty",
+    [SH1106_TRACE_FLUSH_STRIPS] = "render_strips",
+};
+
+void sh1106_trace_record_at(sh1106_trace_type_t type, uint8_t arg8,
+                            uint16_t arg16, uint32_t ts_us) {
+  unsigned slot =
+      atomic_fetch_add_explicit(&s_head, 1, memory_order_relaxed) %
+      TRACE_DEPTH;
+  sh1106_trace_event_t *ev = &s_ring[slot];
+
+  ev->ts_us = ts_us;
+  ev->type = type;
+  ev->arg8 = arg8;
+  ev->arg16 = arg16;
+  ev->task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+}
+
+void sh1106_trace_record(sh1106_trace_type_t type, uint8_t arg8,
+                         uint16_t arg16) {
+  sh1106_trace_record_at(type, arg8, arg16, (uint32_t)esp_timer_get_time());
+}
+
+void sh1106_trace_reset(void) {
+  atomic_store_explicit(&s_head, 0, memory_order_relaxed);
+}
+
+static void trace_put_u16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void trace_put_u32(uint8_t *p, uint32_t v) {
+  trace_put_u16(p, v & 0xFFFF);
+  trace_put_u16(p + 2, v >> 16);
+}
+
+static void trace_dump_binary(unsigned start, unsigned count,
+                              sh1106_trace_write_t write, void *ctx) {
+  uint8_t header[TRACE_HEADER_SIZE] = {0};
+  memcpy(header, SH1106_TRACE_MAGIC, 4);
+  header[4] = SH1106_TRACE_VERSION;
+  header[5] = TRACE_EVENT_SIZE;
+  trace_put_u32(header + 8, count);
+  write(header, sizeof(header), ctx);
+
+  // Serialize explicitly so the stream is little-endian on any host
+  uint8_t chunk[32 * TRACE_EVENT_SIZE];
+  size_t n = 0;
+  for (unsigned i = 0; i < count; i++) {
+    const sh1106_trace_event_t *ev = &s_ring[(start + i) % TRACE_DEPTH];
+    trace_put_u32(chunk + n, ev->ts_us);
+    chunk[n + 4] = ev->type;
+    chunk[n + 5] = ev->arg8;
+    trace_put_u16(chunk + n + 6, ev->arg16);
+    trace_put_u32(chunk + n + 8, ev->task);
+    n += TRACE_EVENT_SIZE;
+    if (n == sizeof(chunk)) {
+      write(chunk, n, ctx);
+      n = 0;
+    }
+  }
+  if (n > 0) {
+    write(chunk, n, ctx);
+  }
+}
+
+static void trace_dump_json(unsigned start, unsigned count,
+                            sh1106_trace_write_t write, void *ctx) {
+  static const char head[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  static const char tail[] = "\n]}\n";
+  char line[160];
+  int64_t now = 0; // Unwrapped time of the current event
+  bool first = true;
+
+  write(head, sizeof(head) - 1, ctx);
+
+  for (unsigned i = 0; i < count; i++) {
+    const sh1106_trace_event_t *ev = &s_ring[(start + i) % TRACE_DEPTH];
+    if (ev->type >= sizeof(s_desc) / sizeof(s_desc[0])) {
+      continue;
+    }
+
+    // Timestamps are 32-bit microseconds; unwrap across the 71 min rollover
+    // by taking each step as signed, so events recorded late step back
+    if (first) {
+      now = ev->ts_us;
+    } else {
+      now += (int32_t)(ev->ts_us - (uint32_t)now);
+    }
+
+    const trace_desc_t *d = &s_desc[ev->type];
+    const char *name = d->name;
+    if (name == NULL) {
+      name = ev->arg8 < sizeof(s_flush_names) / sizeof(s_flush_names[0])
+                 ? s_flush_names[ev->arg8]
+                 : "flush";
+    }
+
+    int len = snprintf(line, sizeof(line),
+                       "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,"
+                       "\"pid\":1,\"tid\":%lu",
+                       first ? "" : ",\n", name, d->phase, (long long)now,
+                       (unsigned long)ev->task);
+    if (d->phase == 'i') {
+      len += snprintf(line + len, sizeof(line) - len, ",\"s\":\"t\"");
+    }
+    if (d->arg8 != NULL) {
+      len += snprintf(line + len, sizeof(line) - len,
+                      ",\"args\":{\"%s\":%u", d->arg8, ev->arg8);
+      if (d->arg16 != NULL) {
+        len += snprintf(line + len, sizeof(line) - len, ",\"%s\":%u",
+                        d->arg16, ev->arg16);
+      }
+      len += snprintf(line + len, sizeof(line) - len, "}");
+    }
+    len += snprintf(line + len, sizeof(line) - len, "}");
+
+    write(line, len, ctx);
+    first = false;
+  }
+
+  write(tail, sizeof(tail) - 1, ctx);
+}
+
+esp_err_t sh1106_trace_dump(sh1106_trace_format_t format,
+                            sh1106_trace_write_t write, void *ctx) {
+  if (write == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  unsigned head = atomic_load_explicit(&s_head, memory_order_relaxed);
+  unsigned count = head < TRACE_DEPTH ? head : TRACE_DEPTH;
+  unsigned start = head - count;
+
+  switch (format) {
+  case SH1106_TRACE_FORMAT_JSON:
+    trace_dump_json(start, count, write, ctx);
+    return ESP_OK;
+  case SH1106_TRACE_FORMAT_BINARY:
+    trace_dump_binary(start, count, write, ctx);
+    return ESP_OK;
+  default:
+    return ESP_ERR_INVALID_ARG;
+  }
+}
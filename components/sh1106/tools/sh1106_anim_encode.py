@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Encode a sequence of 1bpp frames into the SH1106 animation format.
+
+Frames are PBM files (P1/P4), PNG/GIF/... images when Pillow is installed,
+or a raw file of concatenated page-major framebuffers (--raw). The output is
+meant to be flashed into a data partition, e.g.
+
+    python sh1106_anim_encode.py -o boot.shan --fps 20 frames/*.pbm
+    parttool.py write_partition --partition-name anim --input boot.shan
+
+See sh1106_anim.h for the container layout.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"SHAN"
+VERSION = 1
+FLAG_LOOP = 0x01
+FRAME_KEY = 0
+FRAME_DELTA = 1
+
+
+def read_pbm(path):
+    """Return (width, height, rows) where rows is a list of lists of 0/1."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    tokens = []
+    pos = 0
+    # Header: magic, width, height (comments allowed)
+    while len(tokens) < 3:
+        while data[pos : pos + 1].isspace():
+            pos += 1
+        if data[pos : pos + 1] == b"#":
+            while data[pos : pos + 1] not in (b"\n", b""):
+                pos += 1
+            continue
+        start = pos
+        while not data[pos : pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    pos += 1
+
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+    if magic == b"P4":
+        stride = (width + 7) // 8
+        rows = []
+        for y in range(height):
+            row = data[pos + y * stride : pos + (y + 1) * stride]
+            rows.append([(row[x >> 3] >> (7 - (x & 7))) & 1 for x in range(width)])
+        return width, height, rows
+    if magic == b"P1":
+        bits = [c - ord("0") for c in data[pos:] if c in b"01"]
+        return width, height, [bits[y * width : (y + 1) * width] for y in range(height)]
+    raise ValueError(f"{path}: unsupported PBM type {magic!r}")
+
+
+def read_image(path, threshold):
+    if path.lower().endswith(".pbm"):
+        return read_pbm(path)
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit(f"{path}: Pillow is required for non-PBM input")
+    img = Image.open(path).convert("L")
+    px = img.load()
+    rows = [
+        [1 if px[x, y] > threshold else 0 for x in range(img.width)]
+        for y in range(img.height)
+    ]
+    return img.width, img.height, rows
+
+
+def to_pages(width, height, rows, dst_width, pages):
+    """Pack rows into page-major bytes: bit r of byte [p][x] is row 8p+r."""
+    if width != dst_width or height != pages * 8:
+        raise ValueError(f"frame is {width}x{height}, expected {dst_width}x{pages * 8}")
+    buf = bytearray(dst_width * pages)
+    for page in range(pages):
+        for x in range(dst_width):
+            byte = 0
+            for r in range(8):
+                byte |= rows[page * 8 + r][x] << r
+            buf[page * dst_width + x] = byte
+    return bytes(buf)
+
+
+def delta_spans(prev, cur, width, pages, merge_gap):
+    """XOR spans per page; runs closer than merge_gap are joined."""
+    spans = []
+    for page in range(pages):
+        base = page * width
+        x = 0
+        while x < width:
+            if prev[base + x] == cur[base + x]:
+                x += 1
+                continue
+            start = x
+            end = x + 1
+            gap = 0
+            x += 1
+            while x < width and gap <= merge_gap:
+                if prev[base + x] != cur[base + x]:
+                    end = x + 1
+                    gap = 0
+                else:
+                    gap += 1
+                x += 1
+            x = end
+            data = bytes(prev[base + i] ^ cur[base + i] for i in range(start, end))
+            spans.append((page, start, data))
+    return spans
+
+
+def encode_frame(prev, cur, index, args):
+    if prev is None or (args.keyframe_interval and index % args.keyframe_interval == 0):
+        return bytes([FRAME_KEY]) + cur
+
+    spans = delta_spans(prev, cur, args.width, args.pages, args.merge_gap)
+    body = bytearray([FRAME_DELTA])
+    body += struct.pack("<H", len(spans))
+    for page, x, data in spans:
+        body += bytes([page, x, len(data)]) + data
+
+    # A delta bigger than a keyframe buys nothing
+    if len(body) > 1 + len(cur):
+        return bytes([FRAME_KEY]) + cur
+    return bytes(body)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("frames", nargs="+", help="frame images in order")
+    parser.add_argument("-o", "--output", required=True)
+    parser.add_argument("--fps", type=int, default=15)
+    parser.add_argument("--loop", action="store_true", help="set the loop flag")
+    parser.add_argument("--width", type=int, default=128)
+    parser.add_argument("--pages", type=int, default=8)
+    parser.add_argument(
+        "--keyframe-interval", type=int, default=0, help="force a keyframe every N frames"
+    )
+    parser.add_argument(
+        "--merge-gap", type=int, default=3, help="join spans separated by at most N bytes"
+    )
+    parser.add_argument("--threshold", type=int, default=127)
+    parser.add_argument(
+        "--raw", action="store_true", help="inputs are concatenated page-major framebuffers"
+    )
+    args = parser.parse_args()
+
+    frame_size = args.width * args.pages
+    frames = []
+    for path in args.frames:
+        if args.raw:
+            with open(path, "rb") as f:
+                data = f.read()
+            if len(data) % frame_size:
+                sys.exit(f"{path}: size is not a multiple of {frame_size}")
+            frames += [data[i : i + frame_size] for i in range(0, len(data), frame_size)]
+        else:
+            w, h, rows = read_image(path, args.threshold)
+            frames.append(to_pages(w, h, rows, args.width, args.pages))
+
+    if not frames or len(frames) > 0xFFFF:
+        sys.exit("need between 1 and 65535 frames")
+
+    records = []
+    prev = None
+    for i, cur in enumerate(frames):
+        records.append(encode_frame(prev, cur, i, args))
+        prev = cur
+
+    header = MAGIC + struct.pack(
+        "<BBBBHHI",
+        VERSION,
+        args.width,
+        args.pages,
+        FLAG_LOOP if args.loop else 0,
+        len(frames),
+        args.fps,
+        0,
+    )
+    offset = len(header) + 4 * len(records)
+    table = bytearray()
+    for rec in records:
+        table += struct.pack("<I", offset)
+        offset += len(rec)
+
+    with open(args.output, "wb") as f:
+        f.write(header + table + b"".join(records))
+
+    keys = sum(1 for r in records if r[0] == FRAME_KEY)
+    print(
+        f"{args.output}: {len(frames)} frames ({keys} key), {offset} bytes, "
+        f"{offset / len(frames):.0f} bytes/frame"
+    )
+
+
+if __name__ == "__main__":
+    main()
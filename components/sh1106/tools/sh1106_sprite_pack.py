@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Pack icons and animation strips into an SH1106 sprite atlas.
+
+Inputs are PBM files (P1/P4), PNG/GIF/... images when Pillow is installed,
+or directories of them. A file named name@N.ext is an animation strip of N
+frames side by side; name@N@MS.ext also sets the frame time in ms. Every
+frame is trimmed to its inked box, stored page-major (see sh1106_sprite.h)
+and identical frames are stored once. The output is a C source and header
+pair to build into the application, e.g.
+
+    python sh1106_sprite_pack.py -o main/icons --name icons assets/icons
+
+writes main/icons.c and main/icons.h with an `icons` atlas and an
+ICONS_<NAME> enum entry per sprite. To regenerate on every build, add an
+add_custom_command() with these arguments to the project's CMakeLists.txt.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+from sh1106_anim_encode import read_image
+
+EXTENSIONS = (".pbm", ".png", ".gif", ".bmp")
+NAME_RE = re.compile(r"^(?P<name>[^@]+)(@(?P<frames>\d+))?(@(?P<ms>\d+))?$")
+
+
+def collect(paths):
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            for entry in sorted(os.listdir(path)):
+                if entry.lower().endswith(EXTENSIONS):
+                    files.append(os.path.join(path, entry))
+        else:
+            files.append(path)
+    return files
+
+
+def identifier(text):
+    ident = re.sub(r"\W", "_", text).upper()
+    return "_" + ident if ident[:1].isdigit() else ident
+
+
+def trim(rows, x0, width, height):
+    """Inked box of one frame as (dx, dy, w, h, data); blank frames are 0x0."""
+    ink = [(x, y) for y in range(height) for x in range(width) if rows[y][x0 + x]]
+    if not ink:
+        return 0, 0, 0, 0, b""
+    left = min(x for x, _ in ink)
+    right = max(x for x, _ in ink) + 1
+    top = min(y for _, y in ink)
+    bottom = max(y for _, y in ink) + 1
+    w, h = right - left, bottom - top
+
+    data = bytearray(w * ((h + 7) // 8))
+    for y in range(h):
+        for x in range(w):
+            if rows[top + y][x0 + left + x]:
+                data[(y // 8) * w + x] |= 1 << (y % 8)
+    return left, top, w, h, bytes(data)
+
+
+def pack(files, default_ms, threshold):
+    sprites = []
+    frames = []
+    atlas = bytearray()
+    stored = {}
+
+    for path in files:
+        base = os.path.splitext(os.path.basename(path))[0]
+        m = NAME_RE.match(base)
+        if m is None:
+            raise ValueError(f"{path}: cannot parse sprite name")
+        count = int(m.group("frames") or 1)
+        ms = int(m.group("ms") or (default_ms if count > 1 else 0))
+
+        width, height, rows = read_image(path, threshold)
+        if count == 0 or width % count:
+            raise ValueError(f"{path}: width {width} is not {count} frames")
+        cell = width // count
+        if cell > 255 or height > 255 or ms > 0xFFFF:
+            raise ValueError(f"{path}: {cell}x{height} cell or {ms} ms too large")
+
+        sprites.append((m.group("name"), len(frames), count, ms, cell, height))
+        for i in range(count):
+            dx, dy, w, h, data = trim(rows, i * cell, cell, height)
+            key = (w, h, data)
+            if key not in stored:
+                stored[key] = len(atlas)
+                atlas += data
+            frames.append((stored[key], w, h, dx, dy))
+
+    return sprites, frames, bytes(atlas)
+
+
+def write_header(path, name, sprites):
+    guard = identifier(os.path.basename(path))
+    lines = [
+        "// Generated by sh1106_sprite_pack.py, do not edit",
+        f"#ifndef {guard}",
+        f"#define {guard}",
+        "",
+        '#include "sh1106_sprite.h"',
+        "",
+        "enum {",
+    ]
+    for sprite in sprites:
+        lines.append(f"  {identifier(name)}_{identifier(sprite[0])},")
+    lines += [
+        f"  {identifier(name)}_COUNT,",
+        "};",
+        "",
+        f"extern const sh1106_sprite_atlas_t {name};",
+        "",
+        f"#endif // {guard}",
+    ]
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def write_source(path, header, name, sprites, frames, atlas):
+    lines = [
+        "// Generated by sh1106_sprite_pack.py, do not edit",
+        f'#include "{os.path.basename(header)}"',
+        "",
+        f"static const uint8_t {name}_data[] = {{",
+    ]
+    for i in range(0, len(atlas), 12):
+        chunk = ", ".join(f"0x{b:02X}" for b in atlas[i : i + 12])
+        lines.append(f"    {chunk},")
+    if not atlas:
+        lines.append("    0x00,")
+    lines += ["};", "", f"static const sh1106_sprite_frame_t {name}_frames[] = {{"]
+    for offset, w, h, dx, dy in frames:
+        lines.append(f"    {{{offset}, {w}, {h}, {dx}, {dy}}},")
+    lines += ["};", "", f"static const sh1106_sprite_def_t {name}_sprites[] = {{"]
+    for sprite_name, first, count, ms, cell_w, cell_h in sprites:
+        lines.append(f"    {{{first}, {count}, {ms}, {cell_w}, {cell_h}}}, // {sprite_name}")
+    lines += [
+        "};",
+        "",
+        f"const sh1106_sprite_atlas_t {name} = {{",
+        f"    .data = {name}_data,",
+        f"    .frames = {name}_frames,",
+        f"    .sprites = {name}_sprites,",
+        f"    .sprite_count = {len(sprites)},",
+        "};",
+    ]
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("inputs", nargs="+", help="images or directories")
+    parser.add_argument("-o", "--output", required=True, help="output path without extension")
+    parser.add_argument("--name", default="sprites", help="C name of the atlas")
+    parser.add_argument("--frame-ms", type=int, default=100, help="default frame time")
+    parser.add_argument("--threshold", type=int, default=127)
+    args = parser.parse_args()
+
+    if not re.fullmatch(r"[A-Za-z_]\w*", args.name):
+        sys.exit(f"{args.name}: not a C identifier")
+    files = collect(args.inputs)
+    if not files:
+        sys.exit("no input images")
+
+    try:
+        sprites, frames, atlas = pack(files, args.frame_ms, args.threshold)
+    except ValueError as e:
+        sys.exit(str(e))
+
+    header = args.output + ".h"
+    write_header(header, args.name, sprites)
+    write_source(args.output + ".c", header, args.name, sprites, frames, atlas)
+
+    print(
+        f"{args.output}: {len(sprites)} sprites, {len(frames)} frames, "
+        f"{len(atlas)} atlas bytes"
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Convert an SH1106 binary trace dump to Chrome trace-event JSON.
+
+The input is the output of sh1106_trace_dump(SH1106_TRACE_FORMAT_BINARY, ...)
+captured from the device (or a host build). Open the result in
+chrome://tracing or https://ui.perfetto.dev, e.g.
+
+    python sh1106_trace_convert.py trace.bin -o trace.json
+
+The JSON is the same as SH1106_TRACE_FORMAT_JSON produces on the device.
+See sh1106_trace.h for the stream layout.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"SHTR"
+VERSIONS = (1, 2)  # Version 1 records have no task field
+HEADER_SIZE = 16
+
+# name, phase, arg8 name, arg16 name; indexed by sh1106_trace_type_t
+EVENTS = [
+    ("text", "B", "page", None),
+    ("text", "E", "page", "cols"),
+    ("clear", "i", "page", "pages"),
+    (None, "B", None, None),
+    (None, "E", None, None),
+    ("page", "B", "page", "bytes"),
+    ("page", "E", "page", "bytes"),
+    ("bus_error", "i", "page", "err"),
+    ("user", "i", "arg8", "arg16"),
+]
+
+FLUSH_NAMES = ["update_display", "update_dirty", "render_strips"]
+
+
+def parse(data):
+    if len(data) < HEADER_SIZE or data[:4] != MAGIC:
+        raise ValueError("not an SH1106 trace")
+    version, rec_size, _, count = struct.unpack_from("<BBHI", data, 4)
+    if version not in VERSIONS:
+        raise ValueError(f"unsupported trace version {version}")
+    if len(data) < HEADER_SIZE + count * rec_size:
+        raise ValueError("trace is truncated")
+    for i in range(count):
+        offset = HEADER_SIZE + i * rec_size
+        ts, etype, arg8, arg16 = struct.unpack_from("<IBBH", data, offset)
+        task = struct.unpack_from("<I", data, offset + 8)[0] if version >= 2 else 1
+        yield ts, etype, arg8, arg16, task
+
+
+def to_json(events):
+    lines = []
+    now = None
+    for ts, etype, arg8, arg16, task in events:
+        if etype >= len(EVENTS):
+            continue
+        # 32-bit microsecond timestamps wrap every ~71 minutes. Take each
+        # step as signed, so events recorded late step back.
+        if now is None:
+            now = ts
+        else:
+            step = (ts - now) & 0xFFFFFFFF
+            now += step - (1 << 32) if step >= 1 << 31 else step
+
+        name, phase, name8, name16 = EVENTS[etype]
+        if name is None:
+            name = FLUSH_NAMES[arg8] if arg8 < len(FLUSH_NAMES) else "flush"
+
+        line = f'{{"name":"{name}","ph":"{phase}","ts":{now},"pid":1,"tid":{task}'
+        if phase == "i":
+            line += ',"s":"t"'
+        if name8 is not None:
+            line += f',"args":{{"{name8}":{arg8}'
+            if name16 is not None:
+                line += f',"{name16}":{arg16}'
+            line += "}"
+        lines.append(line + "}")
+
+    return '{"displayTimeUnit":"ms","traceEvents":[\n' + ",\n".join(lines) + "\n]}\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="binary trace dump")
+    parser.add_argument("-o", "--output", help="JSON file (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    try:
+        text = to_json(parse(data))
+    except ValueError as e:
+        sys.exit(f"{args.input}: {e}")
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()